@@ -13,9 +13,14 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "sudoku_bank.h"
+#include "sudoku_batch.h"
 #include "sudoku_board.h"
 #include "sudoku_commands.h"
+#include "sudoku_generator.h"
+#include "sudoku_parallel.h"
 #include "sudoku_test_digits.h"
+#include "sudoku_undo.h"
 #include "sudoku_utility.h"
 
 /*
@@ -43,31 +48,167 @@ int main(int argc, char* argv[])
      const struct SudokuCommand *command = NULL;
      SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
 
+     // batch mode: solve a file of puzzles without any interaction, then quit
+     if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+     {
+          if (argc < 3)
+          {
+               puts("Usage: 'sudoku --batch <puzzle-file> [assistant-type]'");
+               return EXIT_FAILURE;
+          }
+
+          return runBatchSolve(argv[2], argc > 3 ? argv[3] : SUDOKU_BATCH_DEFAULT_ASSISTANT);
+     }
+
+     // parallel batch mode: same as batch mode, but spread across a pool of worker threads
+     if (argc > 1 && strcmp(argv[1], "--parallel-solve") == 0)
+     {
+          if (argc < 3)
+          {
+               puts("Usage: 'sudoku --parallel-solve <puzzle-file> [assistant-type] [thread-count]'");
+               return EXIT_FAILURE;
+          }
+
+          return runParallelSolve(argv[2], argc > 3 ? argv[3] : SUDOKU_BATCH_DEFAULT_ASSISTANT,
+               argc > 4 ? (unsigned) strtoul(argv[4], NULL, 10) : 0);
+     }
+
+     // generate puzzles on every core, writing them in the same format batch mode reads
+     if (argc > 1 && strcmp(argv[1], "--generate") == 0)
+     {
+          if (argc < 3)
+          {
+               puts("Usage: 'sudoku --generate <count> [difficulty] [thread-count]'");
+               return EXIT_FAILURE;
+          }
+
+          return runGenerate(strtoul(argv[2], NULL, 10), argc > 3 ? argv[3] : SUDOKU_GENERATOR_DEFAULT_DIFFICULTY,
+               argc > 4 ? (unsigned) strtoul(argv[4], NULL, 10) : 0);
+     }
+
+     // time how fast commands are found by name
+     if (argc > 1 && strcmp(argv[1], "--benchmark-dispatch") == 0)
+     {
+          return runDispatchBenchmark(argc > 2 ? strtoul(argv[2], NULL, 10) : SUDOKU_DISPATCH_BENCHMARK_ITERATIONS);
+     }
+
+     // convert a text puzzle file into a puzzle bank, then quit
+     if (argc > 1 && strcmp(argv[1], "--convert") == 0)
+     {
+          if (argc < 4)
+          {
+               puts("Usage: 'sudoku --convert <text-file> <puzzle-bank-file>'");
+               return EXIT_FAILURE;
+          }
+
+          return convertToSudokuBank(argv[2], argv[3]);
+     }
+
      initializeSudokuBoard(&board);
      initializeString(&commandInput.string);
 
-     puts("========== Sudoku Game ==========");
-     puts(showAllCommandsPrompt);
-     putchar('\n');
+     // compact mode: boards are printed as single 81-character lines, for piping elsewhere
+     if (argc > 1 && strcmp(argv[1], "--compact") == 0)
+     {
+          setSudokuBoardFormat(SUDOKU_BOARD_FORMAT_COMPACT);
+
+          ++argv;
+          --argc;
+     }
+
+     // script mode: run commands from a file ("-" for stdin) without prompts or board printouts
+     if (argc > 1 && strcmp(argv[1], "--script") == 0)
+     {
+          if (argc < 3)
+          {
+               puts("Usage: 'sudoku [--compact] --script <script-file> [--journal <journal-file>] [puzzle-file]'");
+               return EXIT_FAILURE;
+          }
+
+          commandInput.script = strcmp(argv[2], "-") == 0 ? stdin : fopen(argv[2], "r");
+
+          if (commandInput.script == NULL)
+          {
+               printf("Sorry, script \"%s\" could not be opened\n", argv[2]);
+               return EXIT_FAILURE;
+          }
+
+          setvbuf(commandInput.script, NULL, _IOFBF, SUDOKU_SCRIPT_BUFFER_SIZE);
+
+          argv += 2;
+          argc -= 2;
+     }
+
+     // journal mode: keep every change in a file, and pick up where the last session left off
+     if (argc > 1 && strcmp(argv[1], "--journal") == 0)
+     {
+          bool restored;
+
+          if (argc < 3)
+          {
+               puts("Usage: 'sudoku [--compact] [--script <script-file>] --journal <journal-file> [puzzle-file]'");
+               return EXIT_FAILURE;
+          }
+
+          if (!openHistoryJournal(board.history, argv[2], &restored))
+          {
+               return EXIT_FAILURE;
+          }
+
+          // a puzzle file only starts the game if the journal had nothing to restore
+          argv += 2;
+          argc = restored ? 1 : argc - 2;
+     }
+
+     if (IS_INTERACTIVE(&commandInput))
+     {
+          puts("========== Sudoku Game ==========");
+          puts(showAllCommandsPrompt);
+          putchar('\n');
+     }
 
      // if one argument was provided, go ahead and load sudoku board from textfile
      if (argc > 1)
      {
           // if filename provided by argument cannot be found/read, loadSudokuBoard will
           // print an error statement, and execution will continue with a blank board
-          loadSudokuBoard(argv[1], &board);
+          loadSudokuBoard(argv[1], 0, &board);
      }
 
-     printSudokuBoard(&board);
+     if (IS_INTERACTIVE(&commandInput))
+     {
+          printSudokuBoard(&board);
+     }
 
      while (running)
      {          
           // put extra space between previous output and command prompt
-          putchar('\n');
+          if (IS_INTERACTIVE(&commandInput))
+          {
+               putchar('\n');
+          }
+
+          // a script stops at its last line, just like an 'exit' command
+          if ((command = getCommand(&commandInput)) != NULL)
+          {
+               // running a command on only some of its arguments would quietly do the wrong thing
+               status = commandInput.isTooLong ? SUDOKU_COMMAND_USAGE : command->commandFunction(&board, &commandInput);
 
-          command = getCommand(&commandInput);
+               // everything the command changed is on disk before the next prompt. A script has
+               // nobody waiting on it, so it syncs in batches (and once more when it finishes)
+               syncHistoryJournal(board.history, IS_INTERACTIVE(&commandInput));
+          }
+          else
+          {
+               status = SUDOKU_COMMAND_EXIT;
+          }
 
-          status = command->commandFunction(&board, &commandInput);
+          // script errors say where they happened, since nobody is watching to retry them
+          if (!IS_INTERACTIVE(&commandInput) && (status == SUDOKU_COMMAND_USAGE || status == SUDOKU_COMMAND_FAILURE))
+          {
+               printf("line %lu: '%s' failed\n", commandInput.lineNumber, command->name);
+               ++commandInput.errorCount;
+          }
 
           if (status == SUDOKU_COMMAND_USAGE)
           {
@@ -79,9 +220,14 @@ int main(int argc, char* argv[])
           }
      }
 
-     freeHistory(&board.history);
+     if (commandInput.script && commandInput.script != stdin)
+     {
+          fclose(commandInput.script);
+     }
+
+     freeSudokuBoardResources(&board);
 
-     return 0;
+     return commandInput.errorCount ? EXIT_FAILURE : 0;
 }
 
 
@@ -9,61 +9,153 @@
  *
  *****************************************************************************/
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "sudoku_assistant.h"
 #include "sudoku_board.h"
+#include "sudoku_dlx.h"
+#include "sudoku_lookup.h"
+#include "sudoku_parallel.h"
+#include "sudoku_solver.h"
 #include "sudoku_test_digits.h"
 
 
-HistoryStep assistantCrosshatch(SudokuBoard *board, bool verbose);
-HistoryStep assistantLocked(SudokuBoard *board, bool verbose);
-char scanForSingleCandidate(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT], Coord2D *suggestedSquare);
+bool assistantCrosshatch(SudokuBoard *board, SudokuAssistantResult *result, bool verbose);
+bool assistantLocked(SudokuBoard *board, SudokuAssistantResult *result, bool verbose);
+bool assistantSubsets(SudokuBoard *board, SudokuAssistantResult *result, bool verbose);
+bool assistantFish(SudokuBoard *board, SudokuAssistantResult *result, bool verbose);
+bool assistantChains(SudokuBoard *board, SudokuAssistantResult *result, bool verbose);
+bool assistantExhaustive(SudokuBoard *board, SudokuAssistantResult *result, bool verbose);
+bool assistantDlx(SudokuBoard *board, SudokuAssistantResult *result, bool verbose);
+void addAssistantPlacement(SudokuAssistantResult *result, int row, int column, int digit);
+void startAssistantCandidates(SudokuBoard *board, SudokuAssistantResult *result,
+     SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT]);
+void finishAssistantCandidates(SudokuBoard *board, SudokuAssistantResult *result,
+     SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT]);
+void printAssistantResult(const SudokuAssistantResult *result);
+size_t collectSingleCandidates(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT], SudokuAssistantResult *result);
+SUDOKU_ONCE_FUNCTION(buildSubsetTables);
+bool eliminateSubsetCandidates(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT]);
+bool eliminateFishCandidates(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT]);
+struct SudokuChainGraph;
+void buildChainGraph(struct SudokuChainGraph *graph, SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT]);
+size_t followChains(struct SudokuChainGraph *graph, SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT], int start);
+bool eliminateChainCandidates(struct SudokuChainGraph *graph, SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT]);
 
 
 const SudokuAssistant assistants[] = {
      {"crosshatch", "Uses cross - hatch scanning to identify 'hidden singles'", assistantCrosshatch},
-     {"locked", "Uses row/column range checking to identify 'locked' candidates", assistantLocked}
+     {"locked", "Uses row/column range checking to identify 'locked' candidates", assistantLocked},
+     {"subsets", "Uses naked and hidden pairs, triples and quads to rule out candidates", assistantSubsets},
+     {"fish", "Uses X-Wings, Swordfish and Jellyfish to rule out candidates", assistantFish},
+     {"chains", "Follows chains of strong and weak links between candidates", assistantChains},
+     {"exhaustive", "Searches every possibility to find the complete solution", assistantExhaustive},
+     {"dlx", "Solves the board as an exact-cover problem using Dancing Links", assistantDlx}
 };
 
 #define SUDOKU_ASSISTANT_COUNT sizeof(assistants)/sizeof(*assistants)
 
+/** assistants run by 'solve all', cheapest first. The search assistants are left out: they'd
+    solve anything, so they'd tell nothing about how a person could solve it */
+const char *sudokuPipelineNames[SUDOKU_PIPELINE_STAGE_COUNT] = { "crosshatch", "locked", "subsets", "fish", "chains" };
+
+// assistant names and their abbreviations, built the first time an assistant is looked up
+SudokuNameTable assistantNameTable;
+SudokuOnce assistantNameTableOnce = SUDOKU_ONCE_INIT;
+
+SUDOKU_ONCE_FUNCTION(buildAssistantNameTable)
+{
+     buildSudokuNameTable(&assistantNameTable, assistants, SUDOKU_ASSISTANT_COUNT, sizeof(*assistants));
+     SUDOKU_ONCE_RETURN;
+}
+
+/** number of ways to choose 2, 3 or 4 of a unit's 9 squares (or 9 digits): 36 + 84 + 126 */
+#define SUDOKU_SUBSET_COUNT 246
+#define SUDOKU_SUBSET_SIZE_MIN 2
+#define SUDOKU_SUBSET_SIZE_MAX 4
+
+/**
+ * One choice of 2-4 things out of 9: either squares in a unit (in the order sudokuUnitSquares
+ * lists them) or digits (digit 1 is member 0)
+ */
+struct SudokuSubset {
+     SudokuDigitTestField mask;                /**< bit n set if member n is chosen */
+     int size;
+     int members[SUDOKU_SUBSET_SIZE_MAX];      /**< chosen members, lowest first */
+};
+
+typedef struct SudokuSubset SudokuSubset;
+
+// every subset the 'subsets' and 'fish' assistants try, and the squares of each unit as
+// row * 9 + column. Built the first time either runs, so each pass is a straight walk through the tables
+SudokuSubset sudokuSubsets[SUDOKU_SUBSET_COUNT];
+int sudokuUnitSquares[SUDOKU_UNIT_COUNT][SUDOKU_DIGIT_MAX];
+SudokuOnce sudokuSubsetTablesOnce = SUDOKU_ONCE_INIT;
+
+/** candidates on a board: one per digit per square, numbered (row * 9 + column) * 9 + digit - 1 */
+#define SUDOKU_CANDIDATE_COUNT (SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT * SUDOKU_DIGIT_MAX)
+
+/** a candidate has at most one strong link in each of its 3 units, and one inside its square */
+#define SUDOKU_STRONG_LINK_MAX 4
+
+/** state of a chain: a candidate assumed true or false */
+#define SUDOKU_CHAIN_STATE(candidate, isTrue) ((candidate) * 2 + (isTrue))
+#define SUDOKU_CHAIN_STATE_COUNT (SUDOKU_CANDIDATE_COUNT * 2)
+
+/**
+ * Links between the candidates of a board, and room for searching along them. Two candidates
+ * are strongly linked if at least one of them must be true: the only two places for a digit in
+ * a unit, or the only two digits left in a square. They are weakly linked if at most one can be
+ * true: the same digit in two peers, or two digits in the same square. Weak links aren't stored,
+ * since the peer table and the candidates give them directly.
+ *
+ * A board keeps one of these (SudokuBoard::chainGraph), allocated the first time the 'chains'
+ * assistant runs on it, and reused for every chain followed on that board from then on.
+ */
+struct SudokuChainGraph {
+     unsigned short strongLinks[SUDOKU_CANDIDATE_COUNT][SUDOKU_STRONG_LINK_MAX];
+     unsigned char strongLinkCounts[SUDOKU_CANDIDATE_COUNT];
+     unsigned short queue[SUDOKU_CHAIN_STATE_COUNT];     /**< states reached, in the order they were reached */
+     bool reached[SUDOKU_CHAIN_STATE_COUNT];
+     bool seenByStart[SUDOKU_CANDIDATE_COUNT];          /**< candidates weakly linked to the chain's start */
+};
+
+typedef struct SudokuChainGraph SudokuChainGraph;
+
 const char *sudokuAssistantNoSuggestionMessage = "Sorry, no recommendations found using this assistant\n";
 
-HistoryStep assistantCrosshatch(SudokuBoard * board, bool verbose)
+bool assistantCrosshatch(SudokuBoard * board, SudokuAssistantResult *result, bool verbose)
 {
-     HistoryStep suggestion = { 0 };
-     DigitsPresent digitsPresent;
+     // board keeps track of which digits are present in each row, column, and block
+     const DigitsPresent *digitsPresent = &board->digitsPresent;
      SudokuDigitTestField testFlag;
      int row, column, block, digit;
 
-     // make sure we know which digits are present in each row, column, and block
-     evaluateDigitsPresent(board, &digitsPresent, false);
+     result->placementCount = 0;
 
-     // NOTE: 'suggestion.newValue' is used to represent whether or not the assistant has found a
-     //       value to suggest. If 0 (i.e. false), the loops should continue running. Otherwise,
-     //       suggestion has been found and we can break out.
-     
-     for (row = 0; !suggestion.newValue && row < SUDOKU_ROW_COUNT; ++row)
+     // every cross-hatch is checked, so all the squares it can fill are found in one call
+     for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
      {
           // check if each digit is in the row in question
-          for (digit = 1; !suggestion.newValue && digit <= SUDOKU_DIGIT_MAX; ++digit)
+          for (digit = 1; digit <= SUDOKU_DIGIT_MAX; ++digit)
           {
                testFlag = SUDOKU_TEST_FLAG_SHIFT(digit);
 
                // if row contains that digit...
-               if (digitsPresent.rows[row] & testFlag)
+               if (digitsPresent->rows[row] & testFlag)
                {
                     // ...check which columns also have it
-                    for (column = 0; !suggestion.newValue && column < SUDOKU_COL_COUNT; ++column)
+                    for (column = 0; column < SUDOKU_COL_COUNT; ++column)
                     {
-                         if (digitsPresent.columns[column] & testFlag)
+                         if (digitsPresent->columns[column] & testFlag)
                          {
                               // determine which block the intersection occurs in
                               block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column);
 
                               // if block doesn't already contain that digit...
-                              if (!(digitsPresent.blocks[block] & testFlag))
+                              if (!(digitsPresent->blocks[block] & testFlag))
                               {
                                    // array of Coord2D structs to store blank squares in block
                                    // only 4 possible squares per block, due to row/col intersection
@@ -88,9 +180,9 @@ HistoryStep assistantCrosshatch(SudokuBoard * board, bool verbose)
                                                   // AND if square is not inside outer row/column,
                                                   blockRow != row && blockColumn != column &&
                                                   // AND square's row doesn't already contain digit,
-                                                  !(digitsPresent.rows[blockRow] & testFlag) &&
+                                                  !(digitsPresent->rows[blockRow] & testFlag) &&
                                                   // AND square's column doesnt already contain digit...
-                                                  !(digitsPresent.columns[blockColumn] & testFlag))
+                                                  !(digitsPresent->columns[blockColumn] & testFlag))
                                              {
                                                   // ...then square is valid candidate
                                                   candidates[candidateCount].row = blockRow;
@@ -103,17 +195,7 @@ HistoryStep assistantCrosshatch(SudokuBoard * board, bool verbose)
                                    // if there was only one possible square
                                    if (candidateCount == 1)
                                    {
-                                        // populate the struct for returning values
-                                        suggestion.location = *candidates;
-                                        suggestion.newValue = digit;
-
-                                        // recommend that the user fill that square with the digit
-                                        if (verbose)
-                                        {
-                                             printf("Try changing square %c%d to %d\n",
-                                                  colLabels[candidates->col],
-                                                  candidates->row + 1, digit);
-                                        }
+                                        addAssistantPlacement(result, candidates->row, candidates->col, digit);
                                    }
                               }
                          }
@@ -122,57 +204,29 @@ HistoryStep assistantCrosshatch(SudokuBoard * board, bool verbose)
           }
      }
 
-     // when all cross-hatches have been processed, notify the user if we didn't find any suggestions
-     if (!suggestion.newValue && verbose)
+     // when all cross-hatches have been processed, recommend the first square found
+     if (verbose)
      {
-          printf(sudokuAssistantNoSuggestionMessage);
+          printAssistantResult(result);
      }
 
-     return suggestion;
+     return result->placementCount > 0;
 }
 
-HistoryStep assistantLocked(SudokuBoard * board, bool verbose)
+bool assistantLocked(SudokuBoard * board, SudokuAssistantResult *result, bool verbose)
 {
-     HistoryStep suggestion = { 0 };
-     DigitsPresent digitsPresent;
-     SudokuDigitTestField digitsPossible[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT] = { 0 };
+     SudokuDigitTestField digitsPossible[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
      SudokuDigitTestField testFlag;
      int row, column, block, digit;
 
-     // make sure we know which digits are present in each row, column, and block
-     evaluateDigitsPresent(board, &digitsPresent, false);
-
-     // make initial analysis of possible digits for each square
-     for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
-     {
-          for (column = 0; column < SUDOKU_COL_COUNT; ++column)
-          {
-               // only process squares that have no digit already
-               if (board->contents[row][column] == 0)
-               {
-                    // determine which block we're in currently
-                    block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column);
-
-                    // initialize square with all digits possible
-                    digitsPossible[row][column] = SUDOKU_TEST_ALLDIGITS;
-
-                    // unset any digits PRESENT in the square's row
-                    digitsPossible[row][column] &= ~digitsPresent.rows[row];
-
-                    // unset any digits PRESENT in the square's column
-                    digitsPossible[row][column] &= ~digitsPresent.columns[column];
-
-                    // unset any digits PRESENT in the square's block
-                    digitsPossible[row][column] &= ~digitsPresent.blocks[block];
-               }
-          }
-     }
-
-     // SHORTCUT: If any squares now have only 1 possible candidate, suggest that candidate
-     suggestion.newValue = scanForSingleCandidate(digitsPossible, &suggestion.location);
+     // initial analysis of possible digits for each square is kept up to date by the board.
+     // work on a copy, less anything already ruled out, because locking candidates below only
+     // eliminates them for the sake of this result
+     startAssistantCandidates(board, result, digitsPossible);
 
-     // if suggestion value is still 0, keep looking
-     if (!suggestion.newValue)
+     // SHORTCUT: If any squares now have only 1 possible candidate, suggest those
+     // if nothing was found, keep looking
+     if (!collectSingleCandidates(digitsPossible, result))
      {
           // use "locked candidate rule" to eliminate candidates
 
@@ -306,83 +360,826 @@ HistoryStep assistantLocked(SudokuBoard * board, bool verbose)
           }
 
           // Now that locked candidates have been identified, scan again
-          suggestion.newValue = scanForSingleCandidate(digitsPossible, &suggestion.location);
+          collectSingleCandidates(digitsPossible, result);
      }
 
-     // After all steps, if a suggestion was found, recommend it
-     if (suggestion.newValue && verbose)
+     // keep the candidates that were locked out, so the next call starts from them
+     finishAssistantCandidates(board, result, digitsPossible);
+
+     // After all steps, recommend what was found, or notify the user that nothing was
+     if (verbose)
      {
-          printf("Try changing square %c%d to %d\n",
-               colLabels[suggestion.location.col],
-               suggestion.location.row + 1, suggestion.newValue);
+          printAssistantResult(result);
      }
-     // Otherwise, notify the user that no suggestions were found
-     else if (verbose)
+
+     return result->placementCount > 0;
+}
+
+/**
+ * Looks for naked and hidden subsets (pairs, triples and quads) in every unit, removing the
+ * candidates they rule out, then for a square or block left with a single candidate. Subsets
+ * are looked for again after each round of removals, until a suggestion turns up or nothing
+ * more can be removed.
+ *
+ * A naked subset is N squares of a unit whose candidates, together, are only N digits: those
+ * digits must go in those squares, so no other square of the unit can have them. A hidden
+ * subset is N digits that, together, are possible in only N squares of a unit: those squares
+ * must hold those digits, so they can't hold anything else.
+ */
+bool assistantSubsets(SudokuBoard * board, SudokuAssistantResult *result, bool verbose)
+{
+     SudokuDigitTestField digitsPossible[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+
+     runSudokuOnce(&sudokuSubsetTablesOnce, buildSubsetTables);
+
+     // start from the candidates the board already keeps, less anything ruled out by earlier calls
+     startAssistantCandidates(board, result, digitsPossible);
+
+     while (!collectSingleCandidates(digitsPossible, result) && eliminateSubsetCandidates(digitsPossible));
+
+     finishAssistantCandidates(board, result, digitsPossible);
+
+     if (verbose)
      {
-          printf("Sorry, no recommendations found using this assistant\n");
+          printAssistantResult(result);
      }
 
-     return suggestion;
+     return result->placementCount > 0;
 }
 
-char scanForSingleCandidate(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT], Coord2D *suggestedSquare)
+/**
+ * Looks for fish (X-Wings, Swordfish and Jellyfish) for every digit, removing the candidates they
+ * rule out, then for a square or block left with a single candidate. Like the 'subsets'
+ * assistant, it keeps looking until a suggestion turns up or nothing more can be removed.
+ *
+ * A fish of size N is N rows in which a digit is possible only within the same N columns (or
+ * N columns where it's possible only within the same N rows). The digit has to go in those
+ * columns in those rows, so it can't go anywhere else in the columns.
+ */
+bool assistantFish(SudokuBoard * board, SudokuAssistantResult *result, bool verbose)
 {
-     char suggestionValue = 0;
-     bool suggestionFound = false;
-     int row, column, block, digit, bit, bitFlagged, numberFound;
+     SudokuDigitTestField digitsPossible[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
 
-     // check all squares to see if only one candidate is possible
-     for (row = 0; !suggestionFound && row < SUDOKU_ROW_COUNT; ++row)
+     runSudokuOnce(&sudokuSubsetTablesOnce, buildSubsetTables);
+
+     // start from the candidates the board already keeps, less anything ruled out by earlier calls
+     startAssistantCandidates(board, result, digitsPossible);
+
+     while (!collectSingleCandidates(digitsPossible, result) && eliminateFishCandidates(digitsPossible));
+
+     finishAssistantCandidates(board, result, digitsPossible);
+
+     if (verbose)
      {
-          for (column = 0; !suggestionFound && column < SUDOKU_COL_COUNT; ++column)
+          printAssistantResult(result);
+     }
+
+     return result->placementCount > 0;
+}
+
+/**
+ * Follows alternating inference chains (AICs) between candidates, removing the candidates they
+ * rule out, then looks for a square or block left with a single candidate. Simple coloring
+ * (chains of one digit's strong links) and XY-chains (chains through squares with two
+ * candidates) are both kinds of AIC, so they're found too. Like the 'subsets' assistant, it
+ * keeps looking until a suggestion turns up or nothing more can be removed.
+ */
+bool assistantChains(SudokuBoard * board, SudokuAssistantResult *result, bool verbose)
+{
+     SudokuDigitTestField digitsPossible[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+
+     // the search space stays with the board, so 'solve' and batch mode allocate it just once
+     if (board->chainGraph == NULL && (board->chainGraph = malloc(sizeof(*board->chainGraph))) == NULL)
+     {
+          terminate("ERROR: not enough memory to follow chains");
+     }
+
+     runSudokuOnce(&sudokuSubsetTablesOnce, buildSubsetTables);
+
+     // start from the candidates the board already keeps, less anything ruled out by earlier calls
+     startAssistantCandidates(board, result, digitsPossible);
+
+     while (!collectSingleCandidates(digitsPossible, result) &&
+            eliminateChainCandidates(board->chainGraph, digitsPossible));
+
+     finishAssistantCandidates(board, result, digitsPossible);
+
+     if (verbose)
+     {
+          printAssistantResult(result);
+     }
+
+     return result->placementCount > 0;
+}
+
+/**
+ * Fills in the tables used by the 'subsets' assistant: every subset of 2-4 members out of 9,
+ * smallest first, and the squares making up each unit
+ */
+SUDOKU_ONCE_FUNCTION(buildSubsetTables)
+{
+     SudokuDigitTestField mask, members;
+     int size, count = 0, unit, i;
+
+     for (size = SUDOKU_SUBSET_SIZE_MIN; size <= SUDOKU_SUBSET_SIZE_MAX; ++size)
+     {
+          for (mask = 0; mask <= SUDOKU_TEST_ALLDIGITS; ++mask)
           {
-               numberFound = 0;
-               
-               // count how many '1' bits are set for current square
-               for (bit = 0; bit < SUDOKU_DIGIT_MAX; ++bit)
+               if (countDigitFlags(mask) == size)
                {
-                    // shift current square's SudokuDigitTestField a certain number of bits
-                    // if the least-significant-bit is '1', that is a flagged value
-                    if ((digitsPossible[row][column] >> bit) & 1)
+                    sudokuSubsets[count].mask = mask;
+                    sudokuSubsets[count].size = size;
+
+                    for (i = 0, members = mask; members; members &= members - 1, ++i)
                     {
-                         // we found a flag, so increment the counter
-                         ++numberFound;
+                         sudokuSubsets[count].members[i] = lowestDigitFromFlags(members) - 1;
+                    }
 
-                         // save the position of the set bit, in case we can recommend it
-                         bitFlagged = bit;
+                    ++count;
+               }
+          }
+     }
+
+     for (i = 0; i < SUDOKU_DIGIT_MAX; ++i)
+     {
+          for (unit = 0; unit < SUDOKU_ROW_COUNT; ++unit)
+          {
+               // rows, then columns, then blocks (the same numbering as SudokuBoard.digitCounts)
+               sudokuUnitSquares[unit][i] = unit * SUDOKU_COL_COUNT + i;
+               sudokuUnitSquares[SUDOKU_ROW_COUNT + unit][i] = i * SUDOKU_COL_COUNT + unit;
+               sudokuUnitSquares[SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT + unit][i] =
+                    ((unit / 3) * 3 + i / 3) * SUDOKU_COL_COUNT + (unit % 3) * 3 + i % 3;
+          }
+     }
+
+     SUDOKU_ONCE_RETURN;
+}
+
+/**
+ * Makes one pass over every unit, removing the candidates ruled out by naked and hidden subsets.
+ * Everything is done on bit-fields: a subset's squares (or digits) are a mask, its candidates
+ * (or squares) are the union of its members' masks, and it is a subset when that union has as
+ * many bits set as the subset has members.
+ *
+ * Removals made earlier in the pass are seen by later subsets in the same unit, but the
+ * digit-to-squares masks are only worked out once per unit. That's safe: a mask with extra
+ * squares can only hide a hidden subset, never make up a false one.
+ *
+ * @param digitsPossible Candidates of every square; updated in place
+ * @return True if any candidate was removed
+ */
+bool eliminateSubsetCandidates(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT])
+{
+     SudokuDigitTestField *squares[SUDOKU_DIGIT_MAX];
+     SudokuDigitTestField digitSquares[SUDOKU_DIGIT_MAX];   /**< squares of the unit each digit is possible in */
+     SudokuDigitTestField openSquares, openDigits, combined, others, candidates;
+     const SudokuSubset *subset;
+     bool changed = false;
+     int unit, i;
+
+     for (unit = 0; unit < SUDOKU_UNIT_COUNT; ++unit)
+     {
+          openSquares = 0;
+          openDigits = 0;
+          memset(digitSquares, 0, sizeof(digitSquares));
+
+          for (i = 0; i < SUDOKU_DIGIT_MAX; ++i)
+          {
+               squares[i] = &digitsPossible[0][0] + sudokuUnitSquares[unit][i];
+
+               if (*squares[i])
+               {
+                    openSquares |= 1 << i;
+                    openDigits |= *squares[i];
+
+                    for (candidates = *squares[i]; candidates; candidates &= candidates - 1)
+                    {
+                         digitSquares[lowestDigitFromFlags(candidates) - 1] |= 1 << i;
                     }
                }
+          }
 
-               // if numberFound is 1, then only one candidate exists for this square
-               if (numberFound == 1)
+          for (subset = sudokuSubsets; subset < sudokuSubsets + SUDOKU_SUBSET_COUNT; ++subset)
+          {
+               // naked: the subset's squares are blank, and between them have only 'size' candidates
+               if ((subset->mask & openSquares) == subset->mask)
+               {
+                    for (i = 0, combined = 0; i < subset->size; ++i)
+                    {
+                         combined |= *squares[subset->members[i]];
+                    }
+
+                    if (countDigitFlags(combined) == subset->size)
+                    {
+                         for (others = openSquares & ~subset->mask; others; others &= others - 1)
+                         {
+                              i = lowestDigitFromFlags(others) - 1;
+
+                              if (*squares[i] & combined)
+                              {
+                                   *squares[i] &= ~combined;
+                                   changed = true;
+                              }
+                         }
+                    }
+               }
+
+               // hidden: the subset's digits are still needed, and between them fit only 'size' squares
+               if ((subset->mask & openDigits) == subset->mask)
+               {
+                    for (i = 0, combined = 0; i < subset->size; ++i)
+                    {
+                         combined |= digitSquares[subset->members[i]];
+                    }
+
+                    if (countDigitFlags(combined) == subset->size)
+                    {
+                         for (others = combined; others; others &= others - 1)
+                         {
+                              i = lowestDigitFromFlags(others) - 1;
+
+                              if (*squares[i] & ~subset->mask)
+                              {
+                                   *squares[i] &= subset->mask;
+                                   changed = true;
+                              }
+                         }
+                    }
+               }
+          }
+     }
+
+     return changed;
+}
+
+/**
+ * Makes one pass over every digit, removing the candidates ruled out by fish. Each digit gets a
+ * bitboard: a mask per row of the columns the digit is possible in ('lines[0]'), and the same
+ * per column ('lines[1]'). A set of N base lines is a fish when the union of their masks has N
+ * bits set, and every other line loses the digit from the squares in that union. Sets of 2, 3
+ * and 4 lines come from the same subset table as the 'subsets' assistant.
+ *
+ * @param digitsPossible Candidates of every square; updated in place
+ * @return True if any candidate was removed
+ */
+bool eliminateFishCandidates(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT])
+{
+     SudokuDigitTestField lines[2][SUDOKU_DIGIT_MAX];
+     SudokuDigitTestField testFlag, openLines, covered, others, removed;
+     const SudokuSubset *subset;
+     bool changed = false;
+     int digit, orientation, row, column, line, i;
+
+     for (digit = 1; digit <= SUDOKU_DIGIT_MAX; ++digit)
+     {
+          testFlag = SUDOKU_TEST_FLAG_SHIFT(digit);
+
+          // rows are base lines for orientation 0, columns for orientation 1. The bitboard is
+          // rebuilt for each, so removals made with rows as base lines are seen by columns
+          for (orientation = 0; orientation < 2; ++orientation)
+          {
+               memset(lines, 0, sizeof(lines));
+
+               for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
+               {
+                    for (column = 0; column < SUDOKU_COL_COUNT; ++column)
+                    {
+                         if (digitsPossible[row][column] & testFlag)
+                         {
+                              lines[0][row] |= 1 << column;
+                              lines[1][column] |= 1 << row;
+                         }
+                    }
+               }
+
+               // lines where the digit is already placed have no squares for it, and can't be in a fish
+               for (line = 0, openLines = 0; line < SUDOKU_DIGIT_MAX; ++line)
+               {
+                    openLines |= lines[orientation][line] ? 1 << line : 0;
+               }
+
+               for (subset = sudokuSubsets; subset < sudokuSubsets + SUDOKU_SUBSET_COUNT; ++subset)
+               {
+                    if ((subset->mask & openLines) == subset->mask)
+                    {
+                         for (i = 0, covered = 0; i < subset->size; ++i)
+                         {
+                              covered |= lines[orientation][subset->members[i]];
+                         }
+
+                         if (countDigitFlags(covered) == subset->size)
+                         {
+                              for (others = openLines & ~subset->mask; others; others &= others - 1)
+                              {
+                                   line = lowestDigitFromFlags(others) - 1;
+
+                                   for (removed = lines[orientation][line] & covered; removed; removed &= removed - 1)
+                                   {
+                                        i = lowestDigitFromFlags(removed) - 1;
+
+                                        if (orientation == 0)
+                                        {
+                                             digitsPossible[line][i] &= ~testFlag;
+                                        }
+                                        else
+                                        {
+                                             digitsPossible[i][line] &= ~testFlag;
+                                        }
+
+                                        changed = true;
+                                   }
+
+                                   lines[orientation][line] &= ~covered;
+                              }
+                         }
+                    }
+               }
+          }
+     }
+
+     return changed;
+}
+
+/**
+ * Records the strong links between the candidates left on a board
+ *
+ * @param graph Graph to fill in. Its previous links are discarded
+ * @param digitsPossible Candidates of every square
+ */
+void buildChainGraph(SudokuChainGraph *graph, SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT])
+{
+     const SudokuDigitTestField *possible = digitsPossible[0];
+     int pair[2], count, unit, square, digit, i, j, k;
+
+     memset(graph->strongLinkCounts, 0, sizeof(graph->strongLinkCounts));
+
+     for (square = 0; square < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++square)
+     {
+          // only two digits left in the square: one of them goes there
+          if (countDigitFlags(possible[square]) == 2)
+          {
+               pair[0] = square * SUDOKU_DIGIT_MAX + lowestDigitFromFlags(possible[square]) - 1;
+               pair[1] = square * SUDOKU_DIGIT_MAX + lowestDigitFromFlags(possible[square] & (possible[square] - 1)) - 1;
+
+               graph->strongLinks[pair[0]][graph->strongLinkCounts[pair[0]]++] = (unsigned short) pair[1];
+               graph->strongLinks[pair[1]][graph->strongLinkCounts[pair[1]]++] = (unsigned short) pair[0];
+          }
+     }
+
+     for (digit = 1; digit <= SUDOKU_DIGIT_MAX; ++digit)
+     {
+          for (unit = 0; unit < SUDOKU_UNIT_COUNT; ++unit)
+          {
+               // only two places left for the digit in the unit: one of them gets it
+               for (i = 0, count = 0; count <= 2 && i < SUDOKU_DIGIT_MAX; ++i)
+               {
+                    square = sudokuUnitSquares[unit][i];
+
+                    if (possible[square] & SUDOKU_TEST_FLAG_SHIFT(digit))
+                    {
+                         if (count < 2)
+                         {
+                              pair[count] = square * SUDOKU_DIGIT_MAX + digit - 1;
+                         }
+
+                         ++count;
+                    }
+               }
+
+               if (count == 2)
+               {
+                    for (j = 0; j < 2; ++j)
+                    {
+                         // two squares sharing a row (or column) and a block are linked twice over
+                         for (k = 0; k < graph->strongLinkCounts[pair[j]] &&
+                              graph->strongLinks[pair[j]][k] != pair[1 - j]; ++k);
+
+                         if (k == graph->strongLinkCounts[pair[j]])
+                         {
+                              graph->strongLinks[pair[j]][graph->strongLinkCounts[pair[j]]++] = (unsigned short) pair[1 - j];
+                         }
+                    }
+               }
+          }
+     }
+}
+
+/**
+ * Finds every state that follows from one starting state, breadth first. Assuming a candidate
+ * is false makes each candidate strongly linked to it true; assuming it's true makes each
+ * candidate weakly linked to it false. Following the two kinds of link in turn like this is what
+ * makes a chain alternating.
+ *
+ * @param graph Graph of the board's strong links, with room for the search
+ * @param digitsPossible Candidates of every square
+ * @param start State to start from (see SUDOKU_CHAIN_STATE)
+ * @return Number of states reached, including 'start'. They're listed in graph->queue, and
+ *         flagged in graph->reached
+ */
+size_t followChains(SudokuChainGraph *graph, SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT], int start)
+{
+     const SudokuDigitTestField *possible = digitsPossible[0];
+     size_t head = 0, tail = 0;
+     int state, candidate, square, digit, next, i;
+     SudokuDigitTestField others;
+
+     memset(graph->reached, 0, sizeof(graph->reached));
+
+     graph->reached[start] = true;
+     graph->queue[tail++] = (unsigned short) start;
+
+     while (head < tail)
+     {
+          state = graph->queue[head++];
+          candidate = state / 2;
+          square = candidate / SUDOKU_DIGIT_MAX;
+          digit = candidate % SUDOKU_DIGIT_MAX + 1;
+
+          if (state % 2)
+          {
+               // true: every other digit in the square is false...
+               for (others = possible[square] & ~SUDOKU_TEST_FLAG_SHIFT(digit); others; others &= others - 1)
+               {
+                    next = SUDOKU_CHAIN_STATE(square * SUDOKU_DIGIT_MAX + lowestDigitFromFlags(others) - 1, false);
+
+                    if (!graph->reached[next])
+                    {
+                         graph->reached[next] = true;
+                         graph->queue[tail++] = (unsigned short) next;
+                    }
+               }
+
+               // ...and so is the digit everywhere else it's possible in the square's units
+               for (i = 0; i < SUDOKU_PEER_COUNT; ++i)
+               {
+                    if (possible[sudokuSquarePeers[square][i]] & SUDOKU_TEST_FLAG_SHIFT(digit))
+                    {
+                         next = SUDOKU_CHAIN_STATE(sudokuSquarePeers[square][i] * SUDOKU_DIGIT_MAX + digit - 1, false);
+
+                         if (!graph->reached[next])
+                         {
+                              graph->reached[next] = true;
+                              graph->queue[tail++] = (unsigned short) next;
+                         }
+                    }
+               }
+          }
+          else
+          {
+               // false: the other end of each strong link is true
+               for (i = 0; i < graph->strongLinkCounts[candidate]; ++i)
+               {
+                    next = SUDOKU_CHAIN_STATE(graph->strongLinks[candidate][i], true);
+
+                    if (!graph->reached[next])
+                    {
+                         graph->reached[next] = true;
+                         graph->queue[tail++] = (unsigned short) next;
+                    }
+               }
+          }
+     }
+
+     return tail;
+}
+
+/**
+ * Makes one pass over every candidate, following chains from it to find what can be ruled out:
+ *   - if assuming it's true leads to it being false, it's false
+ *   - if assuming it's false leads to it being true, it's true, and the rest of its square goes
+ *   - if assuming it's false leads to another candidate being true, at least one of the two is
+ *     true, so any candidate weakly linked to both of them is false (the AIC elimination)
+ * Removals made during the pass don't spoil the strong links found at its start: a link that
+ * says "at least one of these is true" stays right when one of them is ruled out.
+ *
+ * @param graph Space for the graph and the search, reused from pass to pass
+ * @param digitsPossible Candidates of every square; updated in place
+ * @return True if any candidate was removed
+ */
+bool eliminateChainCandidates(SudokuChainGraph *graph, SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT])
+{
+     SudokuDigitTestField *possible = digitsPossible[0];
+     SudokuDigitTestField others;
+     bool changed = false, placed = false;
+     size_t reachedCount, i;
+     int start, square, digit, end, endSquare, endDigit, peer, count, j;
+
+     // a digit with one place left in a row or column is placed before any chain is followed.
+     // Blocks are left to collectSingleCandidates; rows and columns would otherwise only be
+     // caught through the strong links they had before an elimination left one candidate
+     for (digit = 1; !placed && digit <= SUDOKU_DIGIT_MAX; ++digit)
+     {
+          for (j = 0; !placed && j < SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT; ++j)
+          {
+               for (i = 0, count = 0; i < SUDOKU_DIGIT_MAX; ++i)
+               {
+                    if (possible[sudokuUnitSquares[j][i]] & SUDOKU_TEST_FLAG_SHIFT(digit))
+                    {
+                         square = sudokuUnitSquares[j][i];
+                         ++count;
+                    }
+               }
+
+               if (count == 1 && possible[square] != SUDOKU_TEST_FLAG_SHIFT(digit))
+               {
+                    possible[square] = SUDOKU_TEST_FLAG_SHIFT(digit);
+                    changed = placed = true;
+               }
+          }
+     }
+
+     buildChainGraph(graph, digitsPossible);
+
+     for (start = 0; !placed && start < SUDOKU_CANDIDATE_COUNT; ++start)
+     {
+          square = start / SUDOKU_DIGIT_MAX;
+          digit = start % SUDOKU_DIGIT_MAX + 1;
+
+          // candidates ruled out earlier in the pass are skipped too
+          if (!(possible[square] & SUDOKU_TEST_FLAG_SHIFT(digit)))
+          {
+               continue;
+          }
+
+          followChains(graph, digitsPossible, SUDOKU_CHAIN_STATE(start, true));
+
+          if (graph->reached[SUDOKU_CHAIN_STATE(start, false)])
+          {
+               possible[square] &= ~SUDOKU_TEST_FLAG_SHIFT(digit);
+               changed = true;
+               continue;
+          }
+
+          reachedCount = followChains(graph, digitsPossible, SUDOKU_CHAIN_STATE(start, false));
+
+          if (graph->reached[SUDOKU_CHAIN_STATE(start, true)])
+          {
+               // a placement is as far as a pass goes: the caller will find it as a single candidate
+               possible[square] = SUDOKU_TEST_FLAG_SHIFT(digit);
+               changed = placed = true;
+               continue;
+          }
+
+          // flag everything weakly linked to the start, to test the far end of each chain against
+          memset(graph->seenByStart, 0, sizeof(graph->seenByStart));
+
+          for (j = 0; j < SUDOKU_DIGIT_MAX; ++j)
+          {
+               graph->seenByStart[square * SUDOKU_DIGIT_MAX + j] = j != digit - 1;
+          }
+
+          for (j = 0; j < SUDOKU_PEER_COUNT; ++j)
+          {
+               graph->seenByStart[sudokuSquarePeers[square][j] * SUDOKU_DIGIT_MAX + digit - 1] = true;
+          }
+
+          for (i = 1; i < reachedCount; ++i)
+          {
+               // only chains ending in a true candidate pair up with the start
+               if (graph->queue[i] % 2 == 0)
                {
-                    suggestionFound = true;
-                    suggestedSquare->row = row;
-                    suggestedSquare->col = column;
+                    continue;
+               }
+
+               end = graph->queue[i] / 2;
+               endSquare = end / SUDOKU_DIGIT_MAX;
+               endDigit = end % SUDOKU_DIGIT_MAX + 1;
+
+               for (others = possible[endSquare] & ~SUDOKU_TEST_FLAG_SHIFT(endDigit); others; others &= others - 1)
+               {
+                    if (graph->seenByStart[endSquare * SUDOKU_DIGIT_MAX + lowestDigitFromFlags(others) - 1])
+                    {
+                         possible[endSquare] &= ~(SUDOKU_TEST_FLAG_SHIFT(lowestDigitFromFlags(others)));
+                         changed = true;
+                    }
+               }
+
+               for (j = 0; j < SUDOKU_PEER_COUNT; ++j)
+               {
+                    peer = sudokuSquarePeers[endSquare][j];
+
+                    if ((possible[peer] & SUDOKU_TEST_FLAG_SHIFT(endDigit)) &&
+                        graph->seenByStart[peer * SUDOKU_DIGIT_MAX + endDigit - 1])
+                    {
+                         possible[peer] &= ~SUDOKU_TEST_FLAG_SHIFT(endDigit);
+                         changed = true;
+                    }
+               }
+          }
+     }
+
+     return changed;
+}
+
+bool assistantExhaustive(SudokuBoard * board, SudokuAssistantResult *result, bool verbose)
+{
+     SudokuSolverStats stats;
+     char solution[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     int row, column;
+
+     result->placementCount = 0;
+
+     if (solveSudokuBoardContents(board->contents, solution, &stats))
+     {
+          // one search answers for every blank square, reading left to right, top to bottom
+          for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
+          {
+               for (column = 0; column < SUDOKU_COL_COUNT; ++column)
+               {
+                    if (board->contents[row][column] == 0)
+                    {
+                         addAssistantPlacement(result, row, column, solution[row][column]);
+                    }
+               }
+          }
+
+          if (verbose)
+          {
+               printf("Search tried %lu guesses, %lu of which had to be backtracked\n",
+                    stats.nodes, stats.backtracks);
+
+               printAssistantResult(result);
+          }
+     }
+     else if (verbose)
+     {
+          puts("Sorry, this sudoku board has no solution. Check for mistakes in the squares already filled");
+     }
+
+     return result->placementCount > 0;
+}
+
+bool assistantDlx(SudokuBoard * board, SudokuAssistantResult *result, bool verbose)
+{
+     HistoryStep steps[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT];
+     SudokuSolverStats stats;
+     size_t stepCount, i;
+
+     result->placementCount = 0;
+
+     if (solveSudokuBoardDlx(board->contents, steps, &stepCount, &stats))
+     {
+          // steps come in the order the search committed to them
+          for (i = 0; i < stepCount; ++i)
+          {
+               addAssistantPlacement(result, steps[i].location.row, steps[i].location.col, steps[i].newValue);
+          }
+
+          if (verbose)
+          {
+               printf("Search tried %lu placements, %lu of which had to be backtracked\n",
+                    stats.nodes, stats.backtracks);
+
+               printAssistantResult(result);
+          }
+     }
+     else if (verbose)
+     {
+          puts("Sorry, this sudoku board has no solution. Check for mistakes in the squares already filled");
+     }
+
+     return result->placementCount > 0;
+}
+
+/**
+ * Adds a placement to an assistant's result, unless the result already fills that square
+ * (several deductions often point at the same square)
+ *
+ * @param result Result to add to
+ * @param row Index of the square's row
+ * @param column Index of the square's column
+ * @param digit Digit to place
+ */
+void addAssistantPlacement(SudokuAssistantResult *result, int row, int column, int digit)
+{
+     HistoryStep *placement;
+     size_t i;
+
+     for (i = 0; i < result->placementCount; ++i)
+     {
+          if ((int) result->placements[i].location.row == row && (int) result->placements[i].location.col == column)
+          {
+               return;
+          }
+     }
+
+     placement = &result->placements[result->placementCount++];
+     placement->location.row = row;
+     placement->location.col = column;
+     placement->newValue = (char) digit;
+     placement->oldValue = 0;
+}
+
+/**
+ * Sets up an assistant's working copy of the candidates: the board's own, less the ones an
+ * earlier call already ruled out. Also empties the result's placements.
+ *
+ * @param board Board being examined
+ * @param result Result of the call, holding earlier eliminations
+ * @param digitsPossible Receives the working copy
+ */
+void startAssistantCandidates(SudokuBoard *board, SudokuAssistantResult *result,
+     SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT])
+{
+     int row, column;
+
+     result->placementCount = 0;
+
+     for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
+     {
+          for (column = 0; column < SUDOKU_COL_COUNT; ++column)
+          {
+               digitsPossible[row][column] = board->candidates[row][column] & ~result->eliminations[row][column];
+          }
+     }
+}
+
+/**
+ * Records every candidate an assistant ruled out in its working copy, so later calls with the
+ * same result start without them
+ *
+ * @param board Board being examined
+ * @param result Result of the call
+ * @param digitsPossible The assistant's working copy of the candidates
+ */
+void finishAssistantCandidates(SudokuBoard *board, SudokuAssistantResult *result,
+     SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT])
+{
+     int row, column;
+
+     for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
+     {
+          for (column = 0; column < SUDOKU_COL_COUNT; ++column)
+          {
+               result->eliminations[row][column] |= board->candidates[row][column] & ~digitsPossible[row][column];
+          }
+     }
+}
+
+/**
+ * Recommends the first placement in an assistant's result (the rest are left for the player to
+ * find), or says that there isn't one
+ *
+ * @param result Result to report
+ */
+void printAssistantResult(const SudokuAssistantResult *result)
+{
+     if (result->placementCount > 0)
+     {
+          printf("Try changing square %c%d to %d\n",
+               colLabels[result->placements[0].location.col],
+               (int) result->placements[0].location.row + 1, result->placements[0].newValue);
 
-                    // since only one digit was flagged, 'bitFlagged' is safe to use
-                    // add 1, because bitFlagged represents place-value, which starts at 0
-                    suggestionValue = bitFlagged + 1;
+          if (result->placementCount > 1)
+          {
+               printf("(%lu squares in all can be filled this way)\n", (unsigned long) result->placementCount);
+          }
+     }
+     else
+     {
+          printf(sudokuAssistantNoSuggestionMessage);
+     }
+}
+
+/**
+ * Adds a placement to the result for every square left with a single candidate, and every digit
+ * left with a single square in a block
+ *
+ * @param digitsPossible Candidates of every square
+ * @param result Result to add the placements to
+ * @return Number of placements in the result afterwards
+ */
+size_t collectSingleCandidates(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COUNT], SudokuAssistantResult *result)
+{
+     int row, column, block, digit, bit, lastRow, lastColumn, numberFound;
+
+     // check all squares to see if only one candidate is possible
+     for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
+     {
+          for (column = 0; column < SUDOKU_COL_COUNT; ++column)
+          {
+               // if exactly one bit is set, only one candidate exists for this square
+               if (countDigitFlags(digitsPossible[row][column]) == 1)
+               {
+                    addAssistantPlacement(result, row, column, lowestDigitFromFlags(digitsPossible[row][column]));
                }
           }
      }
 
      // check if any block has only one square possible for a candidate
-     for (digit = 1; !suggestionFound && digit <= SUDOKU_DIGIT_MAX; ++digit)
+     for (digit = 1; digit <= SUDOKU_DIGIT_MAX; ++digit)
      {
           bit = SUDOKU_TEST_FLAG_SHIFT(digit);
           
-          for (block = 0; !suggestionFound && block < SUDOKU_BLOCK_COUNT; ++block)
+          for (block = 0; block < SUDOKU_BLOCK_COUNT; ++block)
           {
                numberFound = 0;
                
                for (row = (block / SUDOKU_BLOCK_HEIGHT) * SUDOKU_BLOCK_HEIGHT;
-                    !suggestionFound &&
                     row < (block / SUDOKU_BLOCK_HEIGHT) * SUDOKU_BLOCK_HEIGHT + SUDOKU_BLOCK_HEIGHT;
                     ++row)
                {
                     for (column = (block % SUDOKU_BLOCK_WIDTH) * SUDOKU_BLOCK_WIDTH;
-                         !suggestionFound &&
                          column < (block % SUDOKU_BLOCK_WIDTH) * SUDOKU_BLOCK_WIDTH + SUDOKU_BLOCK_WIDTH;
                          ++column)
                     {
@@ -393,40 +1190,203 @@ char scanForSingleCandidate(SudokuDigitTestField digitsPossible[][SUDOKU_COL_COU
                               ++numberFound;
 
                               // save the square, in case we can recommend it
-                              suggestedSquare->row = row;
-                              suggestedSquare->col = column;
+                              lastRow = row;
+                              lastColumn = column;
                          }
                     }
                }
 
-               // if only one candidate for that digit exists in current block...
+               // if only one candidate for that digit exists in current block, we have a recommendation
                if (numberFound == 1)
                {
-                    // ...we have a recommendation
-                    suggestionFound = true;
-                    suggestionValue = digit;
+                    addAssistantPlacement(result, lastRow, lastColumn, digit);
                }
           }
      }
 
-     // if no recommendation was found, 'recommendationValue' is still 0 (i.e. false)
-     // otherwise, function returns recommended value for square
-     return suggestionValue;
+     return result->placementCount;
 }
 
+/**
+ * Empties a result, including its eliminations. Needed before a result is used for the first
+ * time, and whenever the board it's used for changes other than by its own placements.
+ *
+ * @param result Result to empty
+ */
+void clearSudokuAssistantResult(SudokuAssistantResult *result)
+{
+     result->placementCount = 0;
+     memset(result->eliminations, 0, sizeof(result->eliminations));
+}
 
-const SudokuAssistant *matchAssistant(char *name)
+/**
+ * Fills in the squares an assistant suggested. A placement is skipped if an earlier one in the
+ * same result has made it impossible, which only happens on a board with a mistake in it.
+ * Skipped placements are taken out of the result, so afterwards it lists exactly the squares
+ * that were filled, in the order they were filled.
+ *
+ * @param board Board to fill in
+ * @param result Result holding the placements
+ * @param isRecorded True to add each change to the board's History
+ * @return Number of squares filled
+ */
+size_t applyAssistantPlacements(SudokuBoard *board, SudokuAssistantResult *result, bool isRecorded)
+{
+     HistoryStep placement;
+     size_t applied = 0, i;
+
+     for (i = 0; i < result->placementCount; ++i)
+     {
+          placement = result->placements[i];
+
+          if (board->candidates[placement.location.row][placement.location.col] &
+              SUDOKU_TEST_FLAG_SHIFT(placement.newValue))
+          {
+               if (isRecorded)
+               {
+                    addUndoStep(board->history, &placement.location, placement.newValue);
+               }
+
+               setSudokuSquare(board, placement.location.row, placement.location.col, placement.newValue);
+               result->placements[applied++] = placement;
+          }
+     }
+
+     result->placementCount = applied;
+
+     return applied;
+}
+
+
+/**
+ * Sets up a pipeline of the assistants in sudokuPipelineNames, with all its counters at 0
+ *
+ * @param pipeline Pipeline to set up
+ */
+void initializeSudokuPipeline(SudokuPipeline *pipeline)
 {
-     const SudokuAssistant *assistant = NULL;
      int i;
 
-     for (i = 0; !assistant && i < SUDOKU_ASSISTANT_COUNT; ++i)
+     memset(pipeline, 0, sizeof(*pipeline));
+     pipeline->hardestStage = -1;
+
+     for (i = 0; i < SUDOKU_PIPELINE_STAGE_COUNT; ++i)
      {
-          if (strcmp(name, assistants[i].name) == 0)
+          pipeline->stages[i].assistant = matchAssistant((char*) sudokuPipelineNames[i]);
+     }
+}
+
+/**
+ * Asks the pipeline's assistants for suggestions, cheapest first, stopping at the first that has
+ * any. Every stage shares one result, so eliminations found by one are used by the rest.
+ *
+ * @param board Board to examine
+ * @param pipeline Pipeline to run; its counters are updated
+ * @param result Result for the board (see SudokuAssistantResult), which receives the placements
+ * @return False if every stage is stuck
+ */
+bool runSudokuPipeline(SudokuBoard *board, SudokuPipeline *pipeline, SudokuAssistantResult *result)
+{
+     SudokuPipelineStage *stage;
+     clock_t start;
+     bool isFound = false;
+     int i;
+
+     for (i = 0; !isFound && i < SUDOKU_PIPELINE_STAGE_COUNT; ++i)
+     {
+          stage = &pipeline->stages[i];
+
+          start = clock();
+          isFound = stage->assistant->assistantFunction(board, result, false);
+          stage->seconds += (double) (clock() - start) / CLOCKS_PER_SEC;
+          ++stage->calls;
+
+          if (isFound)
           {
-               assistant = &assistants[i];
+               ++stage->hits;
+               stage->placements += (unsigned long) result->placementCount;
+
+               if (i > pipeline->hardestStage)
+               {
+                    pipeline->hardestStage = i;
+               }
           }
      }
 
-     return assistant;
-}
\ No newline at end of file
+     return isFound;
+}
+
+/**
+ * Prints how much each stage of a pipeline was used, and the costliest one needed. A puzzle the
+ * pipeline got stuck on isn't graded, since what it needed is beyond every stage.
+ *
+ * @param board Board the pipeline was run on
+ * @param pipeline Pipeline to report on
+ */
+void printSudokuPipelineStats(const SudokuBoard *board, const SudokuPipeline *pipeline)
+{
+     const SudokuPipelineStage *stage;
+     int i;
+
+     printf("%-12s %8s %8s %8s %10s\n", "Technique", "Calls", "Hits", "Squares", "Seconds");
+
+     for (i = 0; i < SUDOKU_PIPELINE_STAGE_COUNT; ++i)
+     {
+          stage = &pipeline->stages[i];
+
+          printf("%-12s %8lu %8lu %8lu %10.6f\n", stage->assistant->name,
+               stage->calls, stage->hits, stage->placements, stage->seconds);
+     }
+
+     if (!isSudokuSolutionValid(board->contents))
+     {
+          puts("Not solved: the puzzle needs more than the techniques above");
+     }
+     else if (pipeline->hardestStage >= 0)
+     {
+          printf("Hardest technique needed: '%s'\n", pipeline->stages[pipeline->hardestStage].assistant->name);
+     }
+}
+
+/**
+ * Finds an assistant by its name, or by any abbreviation of its name that no other assistant
+ * shares (e.g. "cross" for "crosshatch"). Safe to call from several threads at once.
+ *
+ * @param name Name to look for
+ * @return The assistant, or NULL if there is none, or the abbreviation fits more than one
+ */
+const SudokuAssistant *matchAssistant(char *name)
+{
+     int index;
+
+     runSudokuOnce(&assistantNameTableOnce, buildAssistantNameTable);
+     index = lookupSudokuName(&assistantNameTable, name);
+
+     return index >= 0 ? &assistants[index] : NULL;
+}
+
+/**
+ * Counts the solutions of a board, stopping as soon as 'limit' have been found. A limit of 2
+ * answers "does this board have no solution, exactly one, or many?"
+ *
+ * @param board Board to examine. It isn't changed
+ * @param limit Stop counting after this many solutions
+ * @return Number of solutions found, at most 'limit'
+ */
+unsigned long countSolutions(SudokuBoard *board, unsigned long limit)
+{
+     return countSudokuSolutions(board->contents, limit, NULL);
+}
+
+/**
+ * Same as countSolutions, but the search is split up and shared among several threads
+ *
+ * @param board Board to examine. It isn't changed
+ * @param limit Stop counting after this many solutions
+ * @param threadCount Number of worker threads (0 means one per processor)
+ * @return Number of solutions found, at most 'limit'
+ */
+unsigned long countSolutionsParallel(SudokuBoard *board, unsigned long limit, unsigned threadCount)
+{
+     return countSudokuSolutionsParallel(board->contents, limit, threadCount);
+}
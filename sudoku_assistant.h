@@ -6,20 +6,90 @@
 
 #define SUDOKU_ASSISTANT_NAME_LENGTH_MAX 16
 
+/** most placements an assistant can suggest at once: one for every square */
+#define SUDOKU_ASSISTANT_PLACEMENT_MAX (SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT)
+
+/**
+ * Everything an assistant found in one call: every placement it can vouch for, and every
+ * candidate it ruled out along the way.
+ *
+ * Assistants replace the placements on each call, but only ever add to the eliminations, and
+ * treat them as already ruled out. A caller that keeps one result for a board while only
+ * filling squares (like 'solve') never pays for the same elimination twice. Anything else
+ * (undoing, changing a square by hand, switching boards) needs clearSudokuAssistantResult.
+ */
+struct SudokuAssistantResult
+{
+     HistoryStep placements[SUDOKU_ASSISTANT_PLACEMENT_MAX];
+     size_t placementCount;
+     SudokuDigitTestField eliminations[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     /**< candidates ruled out in each square, on top of those the board itself rules out */
+};
+
+typedef struct SudokuAssistantResult SudokuAssistantResult;
+
 struct SudokuAssistant
 {
      char *name;
      char *description;
-     HistoryStep(*assistantFunction)(struct SudokuBoard *board, bool verbose);
+     bool (*assistantFunction)(struct SudokuBoard *board, SudokuAssistantResult *result, bool verbose);
+     /**< fills in 'result', returning true if it holds any placements */
 };
 
 typedef struct SudokuAssistant SudokuAssistant;
 
+/** name 'solve' takes to run every logical assistant as a pipeline, instead of just one */
+#define SUDOKU_PIPELINE_NAME "all"
+
+/** number of assistants in the pipeline (see sudokuPipelineNames) */
+#define SUDOKU_PIPELINE_STAGE_COUNT 5
+
+/**
+ * One assistant in the pipeline, and how much it has been used
+ */
+struct SudokuPipelineStage
+{
+     const SudokuAssistant *assistant;
+     unsigned long calls;       /**< times the assistant was asked for suggestions */
+     unsigned long hits;        /**< calls that ended with at least one placement */
+     unsigned long placements;  /**< squares it suggested, over all its hits */
+     double seconds;            /**< processor time spent inside the assistant */
+};
+
+typedef struct SudokuPipelineStage SudokuPipelineStage;
+
+/**
+ * The logical assistants, cheapest first, run the way a person solves: the cheapest technique
+ * is tried again after any progress, and a costlier one only when all cheaper ones are stuck.
+ * The costliest stage that was ever needed grades the puzzle.
+ */
+struct SudokuPipeline
+{
+     SudokuPipelineStage stages[SUDOKU_PIPELINE_STAGE_COUNT];
+     int hardestStage;          /**< index of the costliest stage that has had a hit, or -1 */
+};
+
+typedef struct SudokuPipeline SudokuPipeline;
+
 extern const SudokuAssistant assistants[];
 
 extern const char *sudokuAssistantNoSuggestionMessage;
 
 const SudokuAssistant *matchAssistant(char *name);
 
+void clearSudokuAssistantResult(SudokuAssistantResult *result);
+
+size_t applyAssistantPlacements(struct SudokuBoard *board, SudokuAssistantResult *result, bool isRecorded);
+
+void initializeSudokuPipeline(SudokuPipeline *pipeline);
+
+bool runSudokuPipeline(struct SudokuBoard *board, SudokuPipeline *pipeline, SudokuAssistantResult *result);
+
+void printSudokuPipelineStats(const struct SudokuBoard *board, const SudokuPipeline *pipeline);
+
+unsigned long countSolutions(struct SudokuBoard *board, unsigned long limit);
+
+unsigned long countSolutionsParallel(struct SudokuBoard *board, unsigned long limit, unsigned threadCount);
+
 #endif // SUDOKU_ASSISTANT_H
 
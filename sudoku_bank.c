@@ -0,0 +1,306 @@
+/******************************************************************************
+ * Program: sudoku_bank.c
+ *
+ * Purpose: Reads and writes "puzzle banks": compact binary files holding
+ *          many sudoku boards at 4 bits per square
+ *
+ *****************************************************************************/
+#include <memory.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "sudoku_bank.h"
+#include "sudoku_reader.h"
+#include "sudoku_utility.h"
+
+
+bool readNextSudokuBankSource(SudokuPuzzleFile *textFile, bool lineFormat, unsigned long *lineNumber,
+     unsigned long *skippedCount, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]);
+void packSudokuBankRecord(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], unsigned char *record);
+void writeSudokuBankHeader(unsigned char *header, unsigned long boardCount);
+unsigned long readLittleEndian(const unsigned char *bytes, int byteCount);
+
+
+/**
+ * Checks whether a puzzle file is a puzzle bank, as opposed to a text file
+ *
+ * @param file Open puzzle file
+ * @return True if the file starts with a puzzle bank header this program understands
+ */
+bool isSudokuBankFile(const SudokuPuzzleFile *file)
+{
+     return file->length >= SUDOKU_BANK_HEADER_SIZE &&
+          memcmp(file->data, SUDOKU_BANK_MAGIC, 4) == 0 &&
+          readLittleEndian((const unsigned char*) file->data + 4, 2) == SUDOKU_BANK_VERSION &&
+          readLittleEndian((const unsigned char*) file->data + 6, 2) == SUDOKU_BANK_RECORD_SIZE;
+}
+
+/**
+ * Number of boards stored in a puzzle bank. A record count that claims more records than the
+ * file holds (e.g. a file cut off while being written) is limited to the complete records.
+ *
+ * @param file Open puzzle file, already checked with isSudokuBankFile
+ */
+size_t getSudokuBankBoardCount(const SudokuPuzzleFile *file)
+{
+     size_t count = readLittleEndian((const unsigned char*) file->data + 8, 4),
+          available = (file->length - SUDOKU_BANK_HEADER_SIZE) / SUDOKU_BANK_RECORD_SIZE;
+
+     return count < available ? count : available;
+}
+
+/**
+ * Reads one board from a puzzle bank, by its position in the file
+ *
+ * @param file Open puzzle file, already checked with isSudokuBankFile
+ * @param index Position of the board in the file, starting from 0
+ * @param contents Receives the board contents
+ * @return False if there is no such board, or its record holds a value that isn't a sudoku digit
+ */
+bool readSudokuBankBoard(const SudokuPuzzleFile *file, size_t index, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
+{
+     bool valid = index < getSudokuBankBoardCount(file);
+
+     if (valid)
+     {
+          const unsigned char *record = (const unsigned char*) file->data +
+               SUDOKU_BANK_HEADER_SIZE + index * SUDOKU_BANK_RECORD_SIZE;
+          char *currentSquare = contents[0];
+          int i;
+
+          for (i = 0; i < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++i)
+          {
+               // even squares are in the high nibble, odd squares in the low nibble
+               currentSquare[i] = (i % 2 == 0) ? record[i / 2] >> 4 : record[i / 2] & 0x0F;
+               valid &= currentSquare[i] <= SUDOKU_DIGIT_MAX;
+          }
+     }
+
+     return valid;
+}
+
+/**
+ * Adds a board to the end of a puzzle bank, creating the file if it doesn't exist yet
+ *
+ * @param fileName Name of the puzzle bank
+ * @param contents Board contents to save
+ * @param index Receives the position of the new board in the file, starting from 0
+ * @return False if the file couldn't be written, or exists but isn't a puzzle bank
+ */
+bool appendSudokuBankBoard(const char *fileName, const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], size_t *index)
+{
+     bool status = true;
+     unsigned char header[SUDOKU_BANK_HEADER_SIZE], record[SUDOKU_BANK_RECORD_SIZE];
+     unsigned long boardCount = 0;
+     FILE *file = fopen(fileName, "r+b");
+
+     if (file)
+     {
+          // existing file must already be a puzzle bank; never overwrite some other file
+          if (fread(header, 1, sizeof(header), file) != sizeof(header) ||
+              memcmp(header, SUDOKU_BANK_MAGIC, 4) != 0 ||
+              readLittleEndian(header + 4, 2) != SUDOKU_BANK_VERSION ||
+              readLittleEndian(header + 6, 2) != SUDOKU_BANK_RECORD_SIZE)
+          {
+               status = false;
+          }
+          else
+          {
+               boardCount = readLittleEndian(header + 8, 4);
+          }
+     }
+     else
+     {
+          file = fopen(fileName, "w+b");
+          status = file != NULL;
+     }
+
+     if (status)
+     {
+          packSudokuBankRecord(contents, record);
+          writeSudokuBankHeader(header, boardCount + 1);
+
+          // write the record first, so a failure part way through leaves the old count intact
+          status = fseek(file, SUDOKU_BANK_HEADER_SIZE + boardCount * SUDOKU_BANK_RECORD_SIZE, SEEK_SET) == 0 &&
+               fwrite(record, 1, sizeof(record), file) == sizeof(record) &&
+               fseek(file, 0, SEEK_SET) == 0 &&
+               fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+          *index = boardCount;
+     }
+
+     if (file)
+     {
+          status &= fclose(file) == 0;
+     }
+
+     return status;
+}
+
+/**
+ * Converts a text puzzle file into a puzzle bank. Boards are read with the same rules as the
+ * 'load' command, so any file that 'load' accepts can be converted: either one board per line
+ * (as for batch mode), or each run of 81 digits is a board and everything else is ignored.
+ * Lines that aren't a board are left out of the bank, and each one is reported, so a bank's
+ * puzzle numbers can be matched back to the lines they came from.
+ *
+ * @param textFileName Name of the text file to read
+ * @param bankFileName Name of the puzzle bank to write (replaced if it exists)
+ * @return Exit status for the program
+ */
+int convertToSudokuBank(const char *textFileName, const char *bankFileName)
+{
+     int status = EXIT_SUCCESS;
+     SudokuPuzzleFile textFile;
+     FILE *bankFile = NULL;
+
+     if (!openSudokuPuzzleFile(&textFile, textFileName))
+     {
+          fprintf(stderr, "Sorry, file \"%s\" not found\n", textFileName);
+          status = EXIT_FAILURE;
+     }
+     else
+     {
+          if ((bankFile = fopen(bankFileName, "wb")) == NULL)
+          {
+               fprintf(stderr, "Sorry, file \"%s\" could not be created\n", bankFileName);
+               status = EXIT_FAILURE;
+          }
+          else
+          {
+               char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+               unsigned char header[SUDOKU_BANK_HEADER_SIZE], record[SUDOKU_BANK_RECORD_SIZE];
+               unsigned long boardCount = 0, lineNumber = 0, skippedCount = 0;
+               bool writeOk, lineFormat = isSudokuLineFile(&textFile);
+
+               // reserve room for the header; it's written once the count is known
+               memset(header, 0, sizeof(header));
+               writeOk = fwrite(header, 1, sizeof(header), bankFile) == sizeof(header);
+
+               while (writeOk && readNextSudokuBankSource(&textFile, lineFormat, &lineNumber, &skippedCount, contents))
+               {
+                    packSudokuBankRecord(contents, record);
+                    writeOk = fwrite(record, 1, sizeof(record), bankFile) == sizeof(record);
+                    ++boardCount;
+               }
+
+               writeSudokuBankHeader(header, boardCount);
+               writeOk = writeOk && fseek(bankFile, 0, SEEK_SET) == 0 &&
+                    fwrite(header, 1, sizeof(header), bankFile) == sizeof(header);
+               writeOk &= fclose(bankFile) == 0;
+
+               if (writeOk)
+               {
+                    fprintf(stderr, "Converted %lu boards into \"%s\"", boardCount, bankFileName);
+
+                    if (skippedCount > 0)
+                    {
+                         fprintf(stderr, " (%lu lines skipped)", skippedCount);
+                    }
+
+                    fputc('\n', stderr);
+               }
+               else
+               {
+                    fprintf(stderr, "Sorry, file \"%s\" could not be written\n", bankFileName);
+                    status = EXIT_FAILURE;
+               }
+          }
+
+          closeSudokuPuzzleFile(&textFile);
+     }
+
+     return status;
+}
+
+/**
+ * Reads the next board to be converted into a puzzle bank. In a file with one board per line,
+ * each line that isn't blank, a '#' comment or a board is reported by number and skipped.
+ * Inner function of 'convertToSudokuBank'
+ *
+ * @param textFile Text file to read from
+ * @param lineFormat True if the file holds one board per line (see isSudokuLineFile)
+ * @param lineNumber Number of the last line read; updated as lines are read
+ * @param skippedCount Number of lines skipped so far; updated as lines are skipped
+ * @param contents Receives the board contents
+ * @return False once the file has no more boards
+ */
+bool readNextSudokuBankSource(SudokuPuzzleFile *textFile, bool lineFormat, unsigned long *lineNumber,
+     unsigned long *skippedCount, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
+{
+     const char *line;
+     size_t lineLength;
+     bool found = false;
+
+     if (!lineFormat)
+     {
+          found = readNextSudokuBoard(textFile, contents) > 0;
+     }
+
+     while (lineFormat && !found && readSudokuFileLine(textFile, &line, &lineLength))
+     {
+          ++*lineNumber;
+
+          // skip blank lines and comments
+          if (lineLength > 0 && line[0] != '#')
+          {
+               if (!(found = parseSudokuBoardLine(line, lineLength, contents)))
+               {
+                    fprintf(stderr, "Line %lu: expected 81 squares (digits, or '.' for blank), skipped\n", *lineNumber);
+                    ++*skippedCount;
+               }
+          }
+     }
+
+     return found;
+}
+
+/**
+ * Packs board contents into a 4-bits-per-square record
+ */
+void packSudokuBankRecord(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], unsigned char *record)
+{
+     const char *currentSquare = contents[0];
+     int i;
+
+     memset(record, 0, SUDOKU_BANK_RECORD_SIZE);
+
+     for (i = 0; i < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++i)
+     {
+          record[i / 2] |= (i % 2 == 0) ? (currentSquare[i] & 0x0F) << 4 : currentSquare[i] & 0x0F;
+     }
+}
+
+/**
+ * Fills in a puzzle bank header for a file holding 'boardCount' boards
+ */
+void writeSudokuBankHeader(unsigned char *header, unsigned long boardCount)
+{
+     memset(header, 0, SUDOKU_BANK_HEADER_SIZE);
+     memcpy(header, SUDOKU_BANK_MAGIC, 4);
+
+     header[4] = SUDOKU_BANK_VERSION & 0xFF;
+     header[5] = SUDOKU_BANK_VERSION >> 8;
+     header[6] = SUDOKU_BANK_RECORD_SIZE & 0xFF;
+     header[7] = SUDOKU_BANK_RECORD_SIZE >> 8;
+     header[8] = boardCount & 0xFF;
+     header[9] = (boardCount >> 8) & 0xFF;
+     header[10] = (boardCount >> 16) & 0xFF;
+     header[11] = (boardCount >> 24) & 0xFF;
+}
+
+/**
+ * Reads an unsigned little-endian integer, regardless of the byte order of this machine
+ */
+unsigned long readLittleEndian(const unsigned char *bytes, int byteCount)
+{
+     unsigned long value = 0;
+
+     while (byteCount-- > 0)
+     {
+          value = (value << 8) | bytes[byteCount];
+     }
+
+     return value;
+}
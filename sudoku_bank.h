@@ -0,0 +1,41 @@
+#ifndef SUDOKU_BANK_H
+#define SUDOKU_BANK_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "sudoku_reader.h"
+#include "sudoku_utility.h"
+
+/*
+ * ======= PUZZLE BANK FORMAT =======
+ * A compact binary file holding any number of boards.
+ *
+ * Header (16 bytes, integers little-endian):
+ *   bytes  0-3:  magic number "SDKB"
+ *   bytes  4-5:  format version (currently 1)
+ *   bytes  6-7:  size of each record in bytes (currently 41)
+ *   bytes  8-11: number of records in the file
+ *   bytes 12-15: reserved, 0
+ *
+ * Records follow the header, one per board. Each square takes 4 bits, reading the board left
+ * to right, top to bottom, high nibble first; the final nibble is padding. Since every record
+ * is the same size, the index of the file is implicit: record N begins at byte 16 + N * 41,
+ * so any puzzle can be read directly without scanning the ones before it.
+ */
+#define SUDOKU_BANK_MAGIC "SDKB"
+#define SUDOKU_BANK_VERSION 1
+#define SUDOKU_BANK_HEADER_SIZE 16
+#define SUDOKU_BANK_RECORD_SIZE ((SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT + 1) / 2)
+
+bool isSudokuBankFile(const SudokuPuzzleFile *file);
+
+size_t getSudokuBankBoardCount(const SudokuPuzzleFile *file);
+
+bool readSudokuBankBoard(const SudokuPuzzleFile *file, size_t index, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]);
+
+bool appendSudokuBankBoard(const char *fileName, const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], size_t *index);
+
+int convertToSudokuBank(const char *textFileName, const char *bankFileName);
+
+#endif // !SUDOKU_BANK_H
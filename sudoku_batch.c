@@ -0,0 +1,122 @@
+/******************************************************************************
+ * Program: sudoku_batch.c
+ *
+ * Purpose: Non-interactive batch mode that solves a whole file of puzzles in
+ *          one run, writing one solution line per puzzle line
+ *
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sudoku_assistant.h"
+#include "sudoku_batch.h"
+#include "sudoku_board.h"
+#include "sudoku_reader.h"
+#include "sudoku_undo.h"
+#include "sudoku_utility.h"
+
+/*
+ * ======= BATCH FILE FORMAT =======
+ * One puzzle per line, 81 characters, reading the board left to right, top to bottom.
+ * Digits 1-9 are given squares; '0' or '.' is a blank square. Lines that are empty or begin
+ * with '#' are skipped. Each solved puzzle is written as one 81-character line in the same
+ * format ('0' for any square the assistant couldn't fill).
+ */
+
+/**
+ * Applies an assistant's suggestions to a board until it runs out, without printing anything.
+ * Each change is recorded in the board's History, just like the 'solve' command.
+ *
+ * @param board Board to fill in
+ * @param assistant Assistant to take suggestions from
+ * @return True if the board ended up a valid solution
+ */
+bool solveWithAssistant(SudokuBoard *board, const SudokuAssistant *assistant)
+{
+     SudokuAssistantResult result;
+
+     // each call's placements are all applied at once; eliminations carry over to the next call
+     clearSudokuAssistantResult(&result);
+
+     while (assistant->assistantFunction(board, &result, false) &&
+            applyAssistantPlacements(board, &result, true) > 0);
+
+     return isSudokuSolutionValid(board->contents);
+}
+
+/**
+ * Solves every puzzle in a batch file, writing solutions to STDOUT and a summary to STDERR.
+ * A single SudokuBoard (and its History) is reused for every puzzle.
+ *
+ * @param fileName Name of the batch file to read
+ * @param assistantName Name of the assistant that will solve each puzzle
+ * @return Exit status for the program
+ */
+int runBatchSolve(const char *fileName, const char *assistantName)
+{
+     int status = EXIT_SUCCESS;
+     const SudokuAssistant *assistant = matchAssistant((char*) assistantName);
+     SudokuPuzzleFile file;
+
+     if (assistant == NULL)
+     {
+          fprintf(stderr, "Sorry, \"%s\" is not a valid assistant.\n", assistantName);
+          status = EXIT_FAILURE;
+     }
+     else if (!openSudokuPuzzleFile(&file, fileName))
+     {
+          fprintf(stderr, "Sorry, file \"%s\" not found\n", fileName);
+          status = EXIT_FAILURE;
+     }
+     else
+     {
+          struct SudokuBoard board = { 0 };
+          const char *line;
+          size_t lineLength;
+          unsigned long lineNumber = 0, puzzleCount = 0, solvedCount = 0;
+
+          initializeSudokuBoard(&board);
+
+          while (readSudokuFileLine(&file, &line, &lineLength))
+          {
+               ++lineNumber;
+
+               // skip blank lines and comments
+               if (lineLength > 0 && line[0] != '#')
+               {
+                    ++puzzleCount;
+
+                    // reset board and history in place, then read the puzzle straight into it
+                    initializeSudokuBoard(&board);
+
+                    if (parseSudokuBoardLine(line, lineLength, board.contents))
+                    {
+                         refreshSudokuBoardDigits(&board);
+
+                         if (solveWithAssistant(&board, assistant))
+                         {
+                              ++solvedCount;
+                         }
+                    }
+                    else
+                    {
+                         fprintf(stderr, "Line %lu: expected 81 squares (digits, or '.' for blank)\n", lineNumber);
+
+                         // keep output lines matched up with input puzzles
+                         initializeSudokuBoard(&board);
+                    }
+
+                    writeSudokuBoardLine(board.contents, stdout);
+               }
+          }
+
+          closeSudokuPuzzleFile(&file);
+          freeSudokuBoardResources(&board);
+
+          fprintf(stderr, "Solved %lu of %lu puzzles\n", solvedCount, puzzleCount);
+     }
+
+     return status;
+}
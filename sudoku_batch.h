@@ -0,0 +1,17 @@
+#ifndef SUDOKU_BATCH_H
+#define SUDOKU_BATCH_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sudoku_assistant.h"
+#include "sudoku_board.h"
+
+/** assistant used when batch mode isn't told which one to use */
+#define SUDOKU_BATCH_DEFAULT_ASSISTANT "exhaustive"
+
+bool solveWithAssistant(SudokuBoard *board, const SudokuAssistant *assistant);
+
+int runBatchSolve(const char *fileName, const char *assistantName);
+
+#endif // !SUDOKU_BATCH_H
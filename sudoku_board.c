@@ -15,67 +15,278 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "sudoku_bank.h"
 #include "sudoku_board.h"
+#include "sudoku_lookup.h"
+#include "sudoku_reader.h"
+#include "sudoku_solver.h"
 #include "sudoku_test_digits.h"
 #include "sudoku_undo.h"
 
+/** longest a board frame printed by printSudokuBoard can be: 38 lines of at most 47 characters */
+#define SUDOKU_BOARD_FRAME_SIZE 2048
+
+/**
+ * A board as printSudokuBoard draws it, with every square blank. Each square is an area 3
+ * characters wide and 'squareHeight' lines tall.
+ */
+struct SudokuBoardFrame {
+     char text[SUDOKU_BOARD_FRAME_SIZE];
+     size_t length;
+     size_t lineLength;   /**< every line of the frame is the same length, so a line down is a fixed step */
+     unsigned short squareOffsets[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     /**< where the top-left corner of each square's area is in 'text' */
+};
+
+typedef struct SudokuBoardFrame SudokuBoardFrame;
+
+// one line per square for the grid, and 3 per square so pencil marks fit in a 3x3 mini-grid
+static SudokuBoardFrame sudokuBoardGridFrame, sudokuBoardCandidatesFrame;
+static SudokuOnce sudokuBoardFramesOnce = SUDOKU_ONCE_INIT;
+
+static SudokuBoardFormat sudokuBoardFormat = SUDOKU_BOARD_FORMAT_GRID;
+
+void buildSudokuBoardFrame(SudokuBoardFrame *frame, int squareHeight);
+SUDOKU_ONCE_FUNCTION(buildSudokuBoardFrames);
+void printSudokuBoardGrid(struct SudokuBoard *board);
+
 
 void initializeSudokuBoard(struct SudokuBoard *board)
 {
-     // allocate new history stack for this fresh board
      if (board->history)
      {
-          // if there is an existing history, free it so it's not leaked
-          freeHistory(&board->history);
+          // if there is an existing history, empty it and reuse its allocation
+          clearHistory(board->history);
+     }
+     else
+     {
+          // allocate new history stack for this fresh board
+          board->history = createHistory(board);
      }
-
-     board->history = createHistory(board);
 
      // initialize board contents to 0;
      memset((void*)&(board->contents), 0, SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT);
+
+     // a new board starts with every candidate pencilled in
+     memset(board->crossedOut, 0, sizeof(board->crossedOut));
+
+     // blank board: no digits present, every digit possible everywhere
+     refreshSudokuBoardDigits(board);
 }
 
 void freeSudokuBoardResources(struct SudokuBoard *board)
 {
      freeHistory(&board->history);
+
+     free(board->chainGraph);
+     board->chainGraph = NULL;
 }
 
-bool loadSudokuBoard(char *fileName, struct SudokuBoard* board)
+/**
+ * Updates the flags and counts for one unit when a digit enters or leaves it
+ *
+ * @param board Board whose derived members are being updated
+ * @param unit Index of the unit (rows 0-8, columns 9-17, blocks 18-26)
+ * @param flags The unit's entry in board->digitsPresent
+ * @param digit Digit entering or leaving
+ * @param isAdded True if the digit is entering the unit, false if leaving
+ */
+void updateSudokuUnitDigit(struct SudokuBoard *board, int unit, SudokuDigitTestField *flags, int digit, bool isAdded)
 {
-     FILE *file;
+     // squares holding blanks (or illegal values) don't count as digits present
+     if (digit > 0 && digit <= SUDOKU_DIGIT_MAX)
+     {
+          if (isAdded)
+          {
+               ++board->digitCounts[unit][digit];
+               *flags |= SUDOKU_TEST_FLAG_SHIFT(digit);
+          }
+          // only unset the flag when the last copy of the digit leaves the unit
+          else if (--board->digitCounts[unit][digit] == 0)
+          {
+               *flags &= ~SUDOKU_TEST_FLAG_SHIFT(digit);
+          }
+     }
+}
 
-     if (file = fopen(fileName, "r"))
+/**
+ * Recalculates which digits are still possible in a square, using the unit flags
+ */
+void updateSudokuSquareCandidates(struct SudokuBoard *board, int row, int column)
+{
+     if (board->contents[row][column] == 0)
      {
-          // reset sudoku board
-          initializeSudokuBoard(board);
-          
-          char *currentSquare = board->contents[0],
-               *boardEnd = board->contents[0] + SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT,
-               input;  // we can use char for input instead of int, because we're checking feof()
+          board->candidates[row][column] = SUDOKU_TEST_ALLDIGITS &
+               ~(board->digitsPresent.rows[row] | board->digitsPresent.columns[column] |
+                 board->digitsPresent.blocks[SUDOKU_BLOCK_FROM_INTERSECTION(row, column)]);
+     }
+     else
+     {
+          board->candidates[row][column] = 0;
+     }
+}
+
+/**
+ * Changes the value of a single square, keeping the board's digit flags and candidates up to date.
+ * Only the square's own row, column and block are touched, so the cost doesn't depend on how
+ * full the board is.
+ *
+ * @param board Board to change
+ * @param row Index of the square's row
+ * @param column Index of the square's column
+ * @param value New value for the square (0 for blank)
+ */
+void setSudokuSquare(struct SudokuBoard *board, int row, int column, char value)
+{
+     int block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column),
+         blockRowOffset = (block / 3) * 3,
+         blockColumnOffset = (block % 3) * 3,
+         oldValue = board->contents[row][column],
+         i;
+     DigitsPresent *present = &board->digitsPresent;
+
+     // remove old digit from the square's units, then add the new one
+     updateSudokuUnitDigit(board, row, &present->rows[row], oldValue, false);
+     updateSudokuUnitDigit(board, SUDOKU_ROW_COUNT + column, &present->columns[column], oldValue, false);
+     updateSudokuUnitDigit(board, SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT + block, &present->blocks[block], oldValue, false);
+
+     board->contents[row][column] = value;
+
+     updateSudokuUnitDigit(board, row, &present->rows[row], value, true);
+     updateSudokuUnitDigit(board, SUDOKU_ROW_COUNT + column, &present->columns[column], value, true);
+     updateSudokuUnitDigit(board, SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT + block, &present->blocks[block], value, true);
+
+     present->squaresIllegalOrBlank[row][column] = value <= 0 || value > SUDOKU_DIGIT_MAX;
+
+     // only squares sharing a unit with the changed square can have different candidates now
+     for (i = 0; i < SUDOKU_DIGIT_MAX; ++i)
+     {
+          updateSudokuSquareCandidates(board, row, i);
+          updateSudokuSquareCandidates(board, i, column);
+          updateSudokuSquareCandidates(board, blockRowOffset + i / 3, blockColumnOffset + i % 3);
+     }
+}
+
+/**
+ * Rebuilds the board's digit flags and candidates from scratch. Needed after 'contents' has been
+ * replaced wholesale (loading a file, starting from a preset); single changes should use
+ * setSudokuSquare instead.
+ *
+ * @param board Board to refresh
+ */
+void refreshSudokuBoardDigits(struct SudokuBoard *board)
+{
+     int row, column, block, value;
+     DigitsPresent *present = &board->digitsPresent;
+
+     memset(present, 0, sizeof(*present));
+     memset(board->digitCounts, 0, sizeof(board->digitCounts));
 
-          while (currentSquare < boardEnd && !feof(file))
+     for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
+     {
+          for (column = 0; column < SUDOKU_COL_COUNT; ++column)
           {
-               // scan file stream until we encounter a digit
-               while (!isdigit(input = getc(file)) && !feof(file)) // break if EOF is encountered
+               value = board->contents[row][column];
+               block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column);
+
+               updateSudokuUnitDigit(board, row, &present->rows[row], value, true);
+               updateSudokuUnitDigit(board, SUDOKU_ROW_COUNT + column, &present->columns[column], value, true);
+               updateSudokuUnitDigit(board, SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT + block, &present->blocks[block], value, true);
+
+               present->squaresIllegalOrBlank[row][column] = value <= 0 || value > SUDOKU_DIGIT_MAX;
+          }
+     }
+
+     for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
+     {
+          for (column = 0; column < SUDOKU_COL_COUNT; ++column)
+          {
+               updateSudokuSquareCandidates(board, row, column);
+          }
+     }
+}
+
+/**
+ * Loads a board from a file: either a text file (see SUDOKU_HELP_LOAD) or a puzzle bank (see
+ * sudoku_bank.h). Either kind of file may hold many boards, one after another.
+ * The board is left unchanged if loading fails.
+ *
+ * @param fileName Name of the file to load
+ * @param puzzleIndex Which board in the file to load, starting from 0
+ * @param board Board that receives the loaded contents
+ * @return True if the board was loaded
+ */
+bool loadSudokuBoard(char *fileName, size_t puzzleIndex, struct SudokuBoard* board)
+{
+     SudokuPuzzleFile file;
+     char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     bool status = true;
+
+     if (openSudokuPuzzleFile(&file, fileName))
+     {
+          if (isSudokuBankFile(&file))
+          {
+               if (!readSudokuBankBoard(&file, puzzleIndex, contents))
                {
-                    ;
+                    printf("Sorry, puzzle bank \"%s\" has no valid puzzle #%lu (it holds %lu)\n",
+                         fileName, (unsigned long) puzzleIndex + 1, (unsigned long) getSudokuBankBoardCount(&file));
+                    status = false;
                }
+          }
+          else if (isSudokuLineFile(&file))
+          {
+               size_t i;
+
+               // one board per line, as written for batch mode; boards before the one
+               // requested are parsed and thrown away
+               for (i = 0; status && i <= puzzleIndex; ++i)
+               {
+                    if (!readNextSudokuBoardLine(&file, contents))
+                    {
+                         printf("Sorry, file \"%s\" holds only %lu puzzles\n", fileName, (unsigned long) i);
+                         status = false;
+                    }
+               }
+          }
+          else
+          {
+               size_t i;
 
-               if (!feof(file))
+               // digits are scanned out of the mapped file; boards before the one requested
+               // are scanned and thrown away
+               for (i = 0; status && i <= puzzleIndex; ++i)
                {
-                    // convert ASCII digit to binary integer by subtracting the ASCII code for 0
-                    *currentSquare++ = input - '0';
+                    // an empty file still loads as a blank board, but only as puzzle #1
+                    if (readNextSudokuBoard(&file, contents) == 0 && i > 0)
+                    {
+                         printf("Sorry, file \"%s\" holds only %lu puzzles\n", fileName, (unsigned long) i);
+                         status = false;
+                    }
                }
           }
+
+          closeSudokuPuzzleFile(&file);
      }
      else {
           printf("Sorry, file \"%s\" not found\n", fileName);
           // return false instead of terminating. program might try to recover.
-          return false;
+          status = false;
      }     
 
-     return true;
+     if (status)
+     {
+          // reset sudoku board
+          initializeSudokuBoard(board);
+
+          memcpy(board->contents, contents, sizeof(contents));
+
+          // contents were written directly, so digit flags and candidates must be rebuilt
+          refreshSudokuBoardDigits(board);
+     }
+
+     return status;
 }
 
 void copySudokuBoardContents(const char source[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], char destination[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
@@ -90,56 +301,199 @@ void copySudokuBoardContents(const char source[SUDOKU_ROW_COUNT][SUDOKU_COL_COUN
      }
 }
 
-void printSudokuBoard(struct SudokuBoard *board)
+/**
+ * Builds a board frame for printSudokuBoard, with blanks where the digits go, and notes where
+ * each square's area starts in it
+ *
+ * @param frame Frame to build
+ * @param squareHeight Number of lines each square takes up. The row label goes on the middle one.
+ */
+void buildSudokuBoardFrame(SudokuBoardFrame *frame, int squareHeight)
 {
      // strings, not #defines: reduce size of compiled code (due to macro expansions)
-     // static variables: only one copy of each string exists across all calls
-     static char *rowDivider = "     ++---+---+---++---+---+---++---+---+---++\n",
-                 *rowDividerThick = "     ++===+===+===++===+===+===++===+===+===++\n",
-                 *rowFormatString = " %d - || %d | %d | %d || %d | %d | %d || %d | %d | %d ||\n",
-                 *xAxisLabel = "        A   B   C    D   E   F    G   H   I\n";
-     int i, j;
+     static const char *rowDivider = "     ++---+---+---++---+---+---++---+---+---++\n",
+                       *rowDividerThick = "     ++===+===+===++===+===+===++===+===+===++\n",
+                       *xAxisLabel = "        A   B   C    D   E   F    G   H   I\n";
+     char *frameEnd = frame->text;
+     int i, j, line;
 
-     fputs(xAxisLabel, stdout);
+     frameEnd += sprintf(frameEnd, "%s", xAxisLabel);
      for (i = 0; i < SUDOKU_ROW_COUNT; ++i)
      {
-          if ( (i % 3) == 0 )
-          {
-               fputs(rowDividerThick, stdout);
-          }
-          else
+          // "thick" divider if on a block boundary
+          frameEnd += sprintf(frameEnd, "%s", (i % 3) == 0 ? rowDividerThick : rowDivider);
+
+          for (line = 0; line < squareHeight; ++line)
           {
-               fputs(rowDivider, stdout);
+               // row label
+               if (line == squareHeight / 2)
+               {
+                    frameEnd += sprintf(frameEnd, " %d - ", i + 1);
+               }
+               else
+               {
+                    frameEnd += sprintf(frameEnd, "     ");
+               }
+
+               for (j = 0; j < SUDOKU_COL_COUNT; ++j)
+               {
+                    // "thick" border if on a block boundary
+                    frameEnd += sprintf(frameEnd, "%s", (j % 3) == 0 ? "||" : "|");
+
+                    if (line == 0)
+                    {
+                         frame->squareOffsets[i][j] = (unsigned short) (frameEnd - frame->text);
+                    }
+
+                    frameEnd += sprintf(frameEnd, "   ");
+               }
+
+               frameEnd += sprintf(frameEnd, "||\n");
           }
+     }
+     frameEnd += sprintf(frameEnd, "%s", rowDividerThick);
+
+     frame->length = (size_t) (frameEnd - frame->text);
+     frame->lineLength = strlen(rowDivider);
+}
+
+/**
+ * Builds the frames printSudokuBoard draws boards in. Runs once, the first time a board is printed.
+ */
+SUDOKU_ONCE_FUNCTION(buildSudokuBoardFrames)
+{
+     buildSudokuBoardFrame(&sudokuBoardGridFrame, 1);
+     buildSudokuBoardFrame(&sudokuBoardCandidatesFrame, SUDOKU_BLOCK_HEIGHT);
+
+     SUDOKU_ONCE_RETURN;
+}
+
+void setSudokuBoardFormat(SudokuBoardFormat format)
+{
+     sudokuBoardFormat = format;
+}
+
+SudokuBoardFormat getSudokuBoardFormat()
+{
+     return sudokuBoardFormat;
+}
+
+/**
+ * Writes board contents as a single 81-character line, using one call to fwrite
+ *
+ * @param contents Board contents to write
+ * @param stream Output stream
+ */
+void writeSudokuBoardLine(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], FILE *stream)
+{
+     char line[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT + 1];
+     const char *currentSquare = contents[0];
+     int i;
+
+     for (i = 0; i < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++i)
+     {
+          line[i] = SUDOKU_DIGIT_VALUE_TO_CHAR(currentSquare[i]);
+     }
+
+     line[i] = '\n';
+
+     fwrite(line, 1, sizeof(line), stream);
+}
+
+/**
+ * Prints the board as a labelled grid: a copy of the prebuilt frame with the board's digits
+ * dropped in, written with one call to fwrite
+ *
+ * @param board Board to print
+ */
+void printSudokuBoardGrid(struct SudokuBoard *board)
+{
+     char text[SUDOKU_BOARD_FRAME_SIZE];
+     const SudokuBoardFrame *frame = &sudokuBoardGridFrame;
+     int i, j;
 
-          // row label
-          printf(" %d - ", i + 1);
+     runSudokuOnce(&sudokuBoardFramesOnce, buildSudokuBoardFrames);
 
+     memcpy(text, frame->text, frame->length);
+
+     for (i = 0; i < SUDOKU_ROW_COUNT; ++i)
+     {
           for (j = 0; j < SUDOKU_COL_COUNT; ++j)
           {
-               // print "thick" border if on a block boundary
-               if ( (j % 3) == 0 )
-               {
-                    fputs("||", stdout);
-               }
-               else
+               // blank if 0, otherwise the digit in the middle of the square
+               if (board->contents[i][j] > 0)
                {
-                    putchar('|');
+                    text[frame->squareOffsets[i][j] + 1] = SUDOKU_DIGIT_VALUE_TO_CHAR(board->contents[i][j]);
                }
+          }
+     }
+
+     fwrite(text, 1, frame->length, stdout);
+}
+
+/**
+ * Prints the board with the pencil marks of every blank square laid out in a 3x3 mini-grid,
+ * each digit in the place it has on a phone keypad. Filled squares show their digit in
+ * brackets, so a lone 5 left in the middle of a mini-grid can't be mistaken for one.
+ *
+ * @param board Board to print
+ */
+void printSudokuBoardCandidates(struct SudokuBoard *board)
+{
+     char text[SUDOKU_BOARD_FRAME_SIZE];
+     const SudokuBoardFrame *frame = &sudokuBoardCandidatesFrame;
+     SudokuDigitTestField marks;
+     char *square;
+     int i, j, digit;
+
+     runSudokuOnce(&sudokuBoardFramesOnce, buildSudokuBoardFrames);
+
+     memcpy(text, frame->text, frame->length);
+
+     for (i = 0; i < SUDOKU_ROW_COUNT; ++i)
+     {
+          for (j = 0; j < SUDOKU_COL_COUNT; ++j)
+          {
+               square = text + frame->squareOffsets[i][j];
 
-               // print blank if 0, otherwise print digit
                if (board->contents[i][j] > 0)
                {
-                    printf(" %d ", board->contents[i][j]);
+                    square[frame->lineLength] = '[';
+                    square[frame->lineLength + 1] = SUDOKU_DIGIT_VALUE_TO_CHAR(board->contents[i][j]);
+                    square[frame->lineLength + 2] = ']';
                }
                else
                {
-                    fputs("   ", stdout);
+                    // visit only the digits that are marked, lowest first
+                    for (marks = SUDOKU_PENCIL_MARKS(board, i, j); marks; marks &= marks - 1)
+                    {
+                         digit = lowestDigitFromFlags(marks) - 1;
+                         square[(digit / 3) * frame->lineLength + digit % 3] = SUDOKU_DIGIT_VALUE_TO_CHAR(digit + 1);
+                    }
                }
           }
+     }
 
-          fputs("||\n", stdout);
+     fwrite(text, 1, frame->length, stdout);
+}
+
+/**
+ * Prints the board in the format chosen with setSudokuBoardFormat
+ *
+ * @param board Board to print
+ */
+void printSudokuBoard(struct SudokuBoard *board)
+{
+     switch (sudokuBoardFormat)
+     {
+     case SUDOKU_BOARD_FORMAT_COMPACT:
+          writeSudokuBoardLine(board->contents, stdout);
+          break;
+     case SUDOKU_BOARD_FORMAT_CANDIDATES:
+          printSudokuBoardCandidates(board);
+          break;
+     default:
+          printSudokuBoardGrid(board);
+          break;
      }
-     fputs(rowDividerThick, stdout);
-     
-}
\ No newline at end of file
+}
@@ -5,25 +5,75 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "sudoku_test_digits.h"
 #include "sudoku_undo.h"
 #include "sudoku_utility.h"
 
+/** number of rows, columns and blocks on a board. Rows are units 0-8, columns 9-17, blocks 18-26 */
+#define SUDOKU_UNIT_COUNT (SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT + SUDOKU_BLOCK_COUNT)
+
+/**
+ * How printSudokuBoard shows a board
+ */
+enum SudokuBoardFormat {
+     SUDOKU_BOARD_FORMAT_GRID,     /**< labelled grid, for people */
+     SUDOKU_BOARD_FORMAT_COMPACT,  /**< one 81-character line, for piping into other programs */
+     SUDOKU_BOARD_FORMAT_CANDIDATES   /**< grid with each blank square's pencil marks in a 3x3 mini-grid */
+};
+
+typedef enum SudokuBoardFormat SudokuBoardFormat;
+
 struct SudokuBoard {
      char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];    /**< NOT a null-terminated string; a collection of small integers */
+
+     // the members below are derived from 'contents'. Change squares with setSudokuSquare so
+     // they stay up to date, or call refreshSudokuBoardDigits after changing 'contents' directly
+
+     DigitsPresent digitsPresent;  /**< digits present in each row, column and block */
+     SudokuDigitTestField candidates[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     /**< digits not yet present in any unit of each blank square (0 for filled squares) */
+     unsigned char digitCounts[SUDOKU_UNIT_COUNT][SUDOKU_DIGIT_MAX + 1];
+     /**< number of times each digit appears in each unit, so removing a repeated digit doesn't
+          unset a flag in 'digitsPresent' that another copy of the digit still needs */
+
+     SudokuDigitTestField crossedOut[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     /**< candidates the player has crossed out of each square's pencil marks ('unmark'). Kept
+          apart from 'candidates' so that placing and removing digits never has to rebuild them */
+
      History history;
+
+     struct SudokuChainGraph *chainGraph;
+     /**< room for the 'chains' assistant to search in. Like 'history', it's allocated the first
+          time it's needed and reused until freeSudokuBoardResources */
 };
 
 typedef struct SudokuBoard SudokuBoard;
 
+/** pencil marks of a square: the candidates the player hasn't crossed out */
+#define SUDOKU_PENCIL_MARKS(board, row, column) \
+     ((board)->candidates[(int) (row)][(int) (column)] & ~(board)->crossedOut[(int) (row)][(int) (column)])
+
 //"initialize", not "create", since it is not allocated
 void initializeSudokuBoard(struct SudokuBoard *board);
 
 void freeSudokuBoardResources(struct SudokuBoard *board);
 
-bool loadSudokuBoard(char *fileName, struct SudokuBoard *board);
+void setSudokuSquare(struct SudokuBoard *board, int row, int column, char value);
+
+void refreshSudokuBoardDigits(struct SudokuBoard *board);
+
+bool loadSudokuBoard(char *fileName, size_t puzzleIndex, struct SudokuBoard *board);
 
 void copySudokuBoardContents(const char source[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], char destination[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]);
 
+void setSudokuBoardFormat(SudokuBoardFormat format);
+
+SudokuBoardFormat getSudokuBoardFormat();
+
+void writeSudokuBoardLine(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], FILE *stream);
+
 void printSudokuBoard(struct SudokuBoard *board);
 
+void printSudokuBoardCandidates(struct SudokuBoard *board);
+
 #endif // !SUDOKU_BOARD_H
\ No newline at end of file
@@ -13,44 +13,77 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 
 #include "sudoku_commands.h"
 #include "sudoku_test_digits.h"
 #include "sudoku_assistant.h"
+#include "sudoku_bank.h"
+#include "sudoku_generator.h"
 #include "sudoku_help.h"
+#include "sudoku_lookup.h"
+#include "sudoku_solver.h"
 
 
-#define IS_ANY_INPUT_REMAINING(inputPtr) ((inputPtr)->currentIndex + 1 < (inputPtr)->string.length)
-#define PEEK_CHAR_FROM_INPUT_STRING_AT_INDEX(inputPtr, index) ((inputPtr)->string.array[index])
+#define IS_ANY_INPUT_REMAINING(inputPtr) ((inputPtr)->currentToken < (inputPtr)->tokenCount)
 
 
 // Forward declarations, so function names are visible for definition of 'commands' array
 SudokuCommandResult commandNew(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandLoad(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandSave(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandCheck(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandCount(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandChange(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandAssist(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandSolve(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandDisplay(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandCandidates(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandMark(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandUnmark(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandUndo(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandRedo(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandGoto(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandHistory(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandBranches(SudokuBoard *board, SudokuCommandInput *input);
+SudokuCommandResult commandBranch(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandHelp(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandExit(SudokuBoard *board, SudokuCommandInput *input);
 SudokuCommandResult commandCommands(SudokuBoard *board, SudokuCommandInput *input);
 
+SudokuCommandResult startRandomSudokuBoard(SudokuBoard *board, SudokuCommandInput *input);
+const struct SudokuCommand *matchCommandLinear(char *name);
+void tokenizeCommandInput(SudokuCommandInput *input);
+bool getTokenArgument(SudokuCommandInput *input, const char **start, size_t *length);
+bool getCharArgument(SudokuCommandInput *input, char *argument);
+const struct SudokuCommand *getScriptCommand(SudokuCommandInput *input);
+SudokuCommandResult changePencilMarks(SudokuBoard *board, SudokuCommandInput *input, bool isMarking);
+
 
 #define SUDOKU_COMMAND_COUNT sizeof(commands)/sizeof(*commands)
 
+/** 'count' stops here unless told otherwise: enough to tell a unique solution from many */
+#define SUDOKU_COUNT_DEFAULT_LIMIT 2
+
 const struct SudokuCommand commands[] = {
      { "new", "Begin new sudoku game", "new <game-type>", SUDOKU_HELP_NEW, commandNew },
-     { "load", "Load sudoku game from text file", "load <filename>", SUDOKU_HELP_LOAD, commandLoad },
+     { "load", "Load sudoku game from text file or puzzle bank", "load <filename> [puzzle-number]", SUDOKU_HELP_LOAD, commandLoad },
+     { "save", "Add sudoku board to a puzzle bank", "save <filename>", SUDOKU_HELP_SAVE, commandSave },
      { "check", "Checks sudoku board to see if solution is correct", "check", SUDOKU_HELP_CHECK, commandCheck },
+     { "count", "Counts the solutions the sudoku board has", "count [limit]", SUDOKU_HELP_COUNT, commandCount },
      { "change", "Change a square's value", "change <column-letter> <row-number> <digit>", SUDOKU_HELP_CHANGE, commandChange },
      { "assist", "Use an assistant to get suggestion", "assist <assistant-type>", SUDOKU_HELP_ASSIST, commandAssist },
-     { "solve", "Let an assistant automatically fill as many squares as it can", "solve <assistant-type>", SUDOKU_HELP_SOLVE, commandSolve },
-     { "display", "Displays the current state of the sudoku board", "display", SUDOKU_HELP_DISPLAY, commandDisplay },
+     { "solve", "Let an assistant automatically fill as many squares as it can", "solve <assistant-type|all>", SUDOKU_HELP_SOLVE, commandSolve },
+     { "display", "Displays the current state of the sudoku board", "display [grid|compact|candidates]", SUDOKU_HELP_DISPLAY, commandDisplay },
+     { "candidates", "Displays the board with every blank square's pencil marks", "candidates", SUDOKU_HELP_CANDIDATES, commandCandidates },
+     { "mark", "Pencils candidates back into a square", "mark <column-letter> <row-number> <digit> [digit...]", SUDOKU_HELP_MARK, commandMark },
+     { "unmark", "Crosses candidates out of a square's pencil marks", "unmark <column-letter> <row-number> <digit> [digit...]", SUDOKU_HELP_UNMARK, commandUnmark },
      { "undo", "Undoes changes made to the board", "undo <number-of-steps>", SUDOKU_HELP_UNDO, commandUndo },
      { "redo", "Redoes changes that were undone", "redo <number-of-steps>", SUDOKU_HELP_REDO, commandRedo },
+     { "goto", "Jumps straight to any step in the board's history", "goto <step>", SUDOKU_HELP_GOTO, commandGoto },
+     { "history", "Shows or sets how the board's history is kept", "history [checkpoint-interval]", SUDOKU_HELP_HISTORY, commandHistory },
+     { "branches", "Lists the branches of the board's history", "branches", SUDOKU_HELP_BRANCHES, commandBranches },
+     { "branch", "Switches to another branch of the board's history", "branch <branch-number>", SUDOKU_HELP_BRANCH, commandBranch },
      { "help", "Offers details about a particular command", "help <command>", SUDOKU_HELP_HELP, commandHelp },
      { "exit", "Exit program", "exit", SUDOKU_HELP_EXIT, commandExit },
      { "commands", "Displays available commands", "commands", SUDOKU_HELP_COMMANDS, commandCommands },
@@ -58,6 +91,16 @@ const struct SudokuCommand commands[] = {
 
 const char *showAllCommandsPrompt = "Type 'commands' to list all available commands.";
 
+// command names and their abbreviations, built the first time a command is looked up
+SudokuNameTable commandNameTable;
+SudokuOnce commandNameTableOnce = SUDOKU_ONCE_INIT;
+
+SUDOKU_ONCE_FUNCTION(buildCommandNameTable)
+{
+     buildSudokuNameTable(&commandNameTable, commands, SUDOKU_COMMAND_COUNT, sizeof(*commands));
+     SUDOKU_ONCE_RETURN;
+}
+
 struct SudokuBoardPreset
 {
      char *name;
@@ -134,17 +177,26 @@ SudokuCommandResult commandNew(SudokuBoard *board, SudokuCommandInput *input)
           }
      }
 
+     // a random puzzle isn't a preset: it's made up on the spot
+     if (strcmp(presetName, "random") == 0)
+     {
+          status = startRandomSudokuBoard(board, input);
+     }
      // if match was found for the preset name provided
-     if (preset)
+     else if (preset)
      {
           // put sudoku board back to clean, default state
           initializeSudokuBoard(board);
 
           // copy board contents from preset into sudoku board
           copySudokuBoardContents(preset->board, board->contents);
+          refreshSudokuBoardDigits(board);
 
           // display new state of the board
-          printSudokuBoard(board);
+          if (IS_INTERACTIVE(input))
+          {
+               printSudokuBoard(board);
+          }
      }
      // if no match was found
      else
@@ -156,24 +208,127 @@ SudokuCommandResult commandNew(SudokuBoard *board, SudokuCommandInput *input)
      return status;
 }
 
+/**
+ * Replaces the board with a newly-generated random puzzle.
+ * Inner function of 'commandNew'
+ */
+SudokuCommandResult startRandomSudokuBoard(SudokuBoard *board, SudokuCommandInput *input)
+{
+     SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
+     // one generator for the life of the program, seeded the first time it's needed
+     static SudokuRandom random = { 0 };
+     const SudokuDifficulty *difficulty;
+     char difficultyName[SUDOKU_DIFFICULTY_NAME_LENGTH_MAX];
+     char puzzle[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     SudokuBoard scratchBoard = { 0 };
+
+     // if no argument was provided for difficulty, use the default
+     if (!getStringArgument(input, difficultyName, sizeof(difficultyName)))
+     {
+          strcpy(difficultyName, SUDOKU_GENERATOR_DEFAULT_DIFFICULTY);
+     }
+
+     if ((difficulty = matchDifficulty(difficultyName)) == NULL)
+     {
+          printf("Sorry, \"%s\" is not a valid difficulty\n", difficultyName);
+          status = SUDOKU_COMMAND_FAILURE;
+     }
+     else
+     {
+          if (random.state == 0)
+          {
+               seedSudokuRandom(&random, (unsigned long long) time(NULL));
+          }
+
+          initializeSudokuBoard(&scratchBoard);
+
+          if (generateSudokuBoard(puzzle, difficulty, &random, &scratchBoard))
+          {
+               initializeSudokuBoard(board);
+               memcpy(board->contents, puzzle, sizeof(puzzle));
+               refreshSudokuBoardDigits(board);
+
+               if (IS_INTERACTIVE(input))
+               {
+                    printSudokuBoard(board);
+               }
+          }
+          else
+          {
+               printf("Sorry, couldn't generate a puzzle of difficulty \"%s\" this time\n", difficulty->name);
+               status = SUDOKU_COMMAND_FAILURE;
+          }
+
+          freeSudokuBoardResources(&scratchBoard);
+     }
+
+     return status;
+}
+
 SudokuCommandResult commandLoad(SudokuBoard *board, SudokuCommandInput *input)
 {
      SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
      char fileName[FILENAME_MAX];
+     unsigned puzzleNumber;
 
      // if argument provided for filename of sudoku input file
      if (getStringArgument(input, fileName, sizeof(fileName)))
      {
-          // if filename exists and board was loaded successfully
-          if (loadSudokuBoard(fileName, board))
+          // without a puzzle number, the first puzzle is loaded. A number given has to count from 1,
+          // or a typo would quietly load the wrong puzzle
+          if (!IS_ANY_INPUT_REMAINING(input))
           {
-               printf("Successfully loaded sudoku board \"%s\"\n\n", fileName);
-               
-               // display new state of the board
-               printSudokuBoard(board);
+               puzzleNumber = 1;
+          }
+          else if (!getUnsignedArgument(input, &puzzleNumber) || puzzleNumber == 0)
+          {
+               status = SUDOKU_COMMAND_USAGE;
+          }
+
+          if (status == SUDOKU_COMMAND_SUCCESS)
+          {
+               // if filename exists and board was loaded successfully
+               if (loadSudokuBoard(fileName, puzzleNumber - 1, board))
+               {
+                    printf("Successfully loaded sudoku board \"%s\"\n\n", fileName);
+
+                    // display new state of the board
+                    if (IS_INTERACTIVE(input))
+                    {
+                         printSudokuBoard(board);
+                    }
+               }
+               else
+               {
+                    status = SUDOKU_COMMAND_FAILURE;
+               }
+          }
+     }
+     // if no argument was provided, that's an invalid command
+     else
+     {
+          status = SUDOKU_COMMAND_USAGE;
+     }
+     
+     return status;
+}
+
+SudokuCommandResult commandSave(SudokuBoard *board, SudokuCommandInput *input)
+{
+     SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
+     char fileName[FILENAME_MAX];
+     size_t index;
+
+     // if argument provided for filename of puzzle bank
+     if (getStringArgument(input, fileName, sizeof(fileName)))
+     {
+          if (appendSudokuBankBoard(fileName, board->contents, &index))
+          {
+               printf("Saved sudoku board as puzzle #%lu in \"%s\"\n", (unsigned long) index + 1, fileName);
           }
           else
           {
+               printf("Sorry, could not save to \"%s\" (is it a puzzle bank?)\n", fileName);
                status = SUDOKU_COMMAND_FAILURE;
           }
      }
@@ -182,7 +337,7 @@ SudokuCommandResult commandLoad(SudokuBoard *board, SudokuCommandInput *input)
      {
           status = SUDOKU_COMMAND_USAGE;
      }
-     
+
      return status;
 }
 
@@ -195,6 +350,35 @@ SudokuCommandResult commandCheck(SudokuBoard *board, SudokuCommandInput *input)
      return SUDOKU_COMMAND_SUCCESS;
 }
 
+SudokuCommandResult commandCount(SudokuBoard *board, SudokuCommandInput *input)
+{
+     unsigned limit;
+     unsigned long count;
+
+     // if no argument was provided for the limit, only tell apart none, one, and many
+     if (!getUnsignedArgument(input, &limit) || limit == 0)
+     {
+          limit = SUDOKU_COUNT_DEFAULT_LIMIT;
+     }
+
+     count = countSolutionsParallel(board, limit, 0);
+
+     if (count == 0)
+     {
+          puts("This sudoku board has no solution");
+     }
+     else if (count < limit)
+     {
+          printf("This sudoku board has exactly %lu solution%s\n", count, count == 1 ? "" : "s");
+     }
+     else
+     {
+          printf("This sudoku board has at least %lu solution%s\n", count, count == 1 ? "" : "s");
+     }
+
+     return SUDOKU_COMMAND_SUCCESS;
+}
+
 SudokuCommandResult commandChange(SudokuBoard *board, SudokuCommandInput *input)
 {
      SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
@@ -211,6 +395,11 @@ SudokuCommandResult commandChange(SudokuBoard *board, SudokuCommandInput *input)
                status = SUDOKU_COMMAND_USAGE;
           }
      }
+     // no arguments were provided, and a script can't answer prompts
+     else if (!IS_INTERACTIVE(input))
+     {
+          status = SUDOKU_COMMAND_USAGE;
+     }
      // no arguments were provided. Prompt for input
      else
      {
@@ -232,7 +421,7 @@ SudokuCommandResult commandChange(SudokuBoard *board, SudokuCommandInput *input)
           addUndoStep(board->history, &square, value);
 
           // change square value
-          board->contents[row][column] = value;
+          setSudokuSquare(board, row, column, value);
 
           // if there were undo steps past this point in the stack, they are now invalidated
           invalidateSubsequentRedoSteps(board->history);
@@ -241,7 +430,10 @@ SudokuCommandResult commandChange(SudokuBoard *board, SudokuCommandInput *input)
                colLabels[column], row + 1, oldValue, value);
 
           // display new state of board
-          printSudokuBoard(board);
+          if (IS_INTERACTIVE(input))
+          {
+               printSudokuBoard(board);
+          }
      }
 
      return status;
@@ -260,7 +452,10 @@ SudokuCommandResult commandAssist(SudokuBoard *board, SudokuCommandInput *input)
           // if assistant exists
           if (assistant = matchAssistant(assistantName))
           {
-               assistant->assistantFunction(board, true);
+               SudokuAssistantResult result;
+
+               clearSudokuAssistantResult(&result);
+               assistant->assistantFunction(board, &result, true);
           }
           else
           {
@@ -283,55 +478,91 @@ SudokuCommandResult commandSolve(SudokuBoard * board, SudokuCommandInput * input
 
      const SudokuAssistant *assistant = NULL;
      char assistantName[SUDOKU_ASSISTANT_NAME_LENGTH_MAX];
+     SudokuPipeline pipeline;
+     bool isPipeline;
 
      // if argument provided for type of assistant to use
      if (getStringArgument(input, assistantName, sizeof(assistantName)))
      {
-          // if assistant exists
-          if (assistant = matchAssistant(assistantName))
+          // "all" runs every logical assistant, cheapest first, instead of just one
+          isPipeline = strcmp(assistantName, SUDOKU_PIPELINE_NAME) == 0;
+
+          if (isPipeline)
           {
-               HistoryStep currentChange = assistant->assistantFunction(board, false);
-               int i;
+               initializeSudokuPipeline(&pipeline);
+          }
 
-               // if we got at least one suggestion
-               if (currentChange.newValue)
-               {
-                    // only need to invalidate subsequent history items ONCE
-                    invalidateSubsequentRedoSteps(board->history);
-               }
-               
-               // as long as assistant keeps returning suggestions:
-               for (i = 1; currentChange.newValue; 
-                    currentChange = assistant->assistantFunction(board, false), ++i)
+          // if assistant exists
+          if (isPipeline || (assistant = matchAssistant(assistantName)))
+          {
+               SudokuAssistantResult result;
+               const HistoryStep *placement;
+               size_t j, placedCount;
+               bool isFound;
+               int i = 1;
+
+               // one result is kept for the whole run, so eliminations found early aren't looked for again
+               clearSudokuAssistantResult(&result);
+               isFound = isPipeline ? runSudokuPipeline(board, &pipeline, &result) :
+                    assistant->assistantFunction(board, &result, false);
+
+               // the whole run is undone and redone as one step
+               beginHistoryGroup(board->history);
+
+               // as long as assistant keeps returning suggestions, fill in everything it found
+               while (isFound)
                {
-                    // create history item
-                    addUndoStep(board->history, &currentChange.location, currentChange.newValue);
-
-                    // change square value
-                    board->contents
-                         [currentChange.location.row]
-                         [currentChange.location.col] = currentChange.newValue;
-
-                    // let the user know what changes are being made
-                    printf("%2d: Changed square %c%d to %d\n",
-                         i, colLabels[currentChange.location.col], 
-                         currentChange.location.row + 1, currentChange.newValue);
+                    // afterwards, the result holds just the placements that were made
+                    placedCount = applyAssistantPlacements(board, &result, true);
+
+                    // if there were undo steps past this point in the stack, they are now invalidated.
+                    // Only needs doing ONCE, and only once the board has actually changed
+                    if (placedCount > 0 && i == 1)
+                    {
+                         invalidateSubsequentRedoSteps(board->history);
+                    }
+
+                    // let the user know what changes were made
+                    for (j = 0; j < placedCount; ++j)
+                    {
+                         placement = &result.placements[j];
+
+                         printf("%2d: Changed square %c%d to %d\n",
+                              i++, colLabels[placement->location.col],
+                              (int) placement->location.row + 1, placement->newValue);
+                    }
+
+                    // if nothing could be placed, asking again would get the same answer
+                    isFound = placedCount > 0 && (isPipeline ? runSudokuPipeline(board, &pipeline, &result) :
+                         assistant->assistantFunction(board, &result, false));
                }
 
+               commitHistoryGroup(board->history);
+
                // if we got at least one suggestion...
                if (i > 1)
                {
                     // put gap between change-log and board-printout
-                    putchar('\n');
+                    if (IS_INTERACTIVE(input))
+                    {
+                         putchar('\n');
 
-                    // display present state of the board
-                    printSudokuBoard(board);
+                         // display present state of the board
+                         printSudokuBoard(board);
+                    }
                }
                // otherwise, let the user know
                else
                {
                     fputs(sudokuAssistantNoSuggestionMessage, stdout);
                }
+
+               // how much work each technique did, and how hard the puzzle turned out to be
+               if (isPipeline)
+               {
+                    putchar('\n');
+                    printSudokuPipelineStats(board, &pipeline);
+               }
           }
           else
           {
@@ -350,12 +581,142 @@ SudokuCommandResult commandSolve(SudokuBoard * board, SudokuCommandInput * input
 
 SudokuCommandResult commandDisplay(SudokuBoard *board, SudokuCommandInput *input)
 {
+     SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
+     char formatName[SUDOKU_COMMAND_NAME_LENGTH_MAX];
+
+     // a format, if given, is kept for every board printed after this one
+     if (getStringArgument(input, formatName, sizeof(formatName)))
+     {
+          if (strcmp(formatName, "grid") == 0)
+          {
+               setSudokuBoardFormat(SUDOKU_BOARD_FORMAT_GRID);
+          }
+          else if (strcmp(formatName, "compact") == 0)
+          {
+               setSudokuBoardFormat(SUDOKU_BOARD_FORMAT_COMPACT);
+          }
+          else if (strcmp(formatName, "candidates") == 0)
+          {
+               setSudokuBoardFormat(SUDOKU_BOARD_FORMAT_CANDIDATES);
+          }
+          else
+          {
+               printf("Sorry, \"%s\" is not a board format\n", formatName);
+               status = SUDOKU_COMMAND_USAGE;
+          }
+     }
+
      // display present state of the board
-     printSudokuBoard(board);
-     
+     if (status == SUDOKU_COMMAND_SUCCESS)
+     {
+          printSudokuBoard(board);
+     }
+
+     return status;
+}
+
+SudokuCommandResult commandCandidates(SudokuBoard *board, SudokuCommandInput *input)
+{
+     // display the board with pencil marks, whatever format boards are usually shown in
+     printSudokuBoardCandidates(board);
+
      return SUDOKU_COMMAND_SUCCESS;
 }
 
+SudokuCommandResult commandMark(SudokuBoard *board, SudokuCommandInput *input)
+{
+     return changePencilMarks(board, input, true);
+}
+
+SudokuCommandResult commandUnmark(SudokuBoard *board, SudokuCommandInput *input)
+{
+     return changePencilMarks(board, input, false);
+}
+
+/**
+ * Reads a square and one or more digits, then pencils the digits into the square's marks or
+ * crosses them out. Only a bit of board->crossedOut changes per digit; a digit that's already
+ * in one of the square's units can't be pencilled in, since it isn't a candidate at all.
+ *
+ * @param board Board whose pencil marks are changed
+ * @param input Command input, holding "<column-letter> <row-number> <digit> [digit...]"
+ * @param isMarking True to pencil the digits in ('mark'), false to cross them out ('unmark')
+ * @return SUDOKU_COMMAND_USAGE if the arguments are missing or invalid
+ */
+SudokuCommandResult changePencilMarks(SudokuBoard *board, SudokuCommandInput *input, bool isMarking)
+{
+     SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
+     SudokuDigitTestField digits = 0;
+     char columnArgument, rowArgument, value;
+     int column = 0, row = 0;
+
+     if (!getColumnArgument(input, &columnArgument) || !getRowArgument(input, &rowArgument))
+     {
+          status = SUDOKU_COMMAND_USAGE;
+     }
+     else
+     {
+          // read as chars, but used as array indices from here on
+          column = columnArgument;
+          row = rowArgument;
+     }
+
+     // every remaining argument is a digit
+     while (status == SUDOKU_COMMAND_SUCCESS && IS_ANY_INPUT_REMAINING(input))
+     {
+          if (getSudokuDigitArgument(input, &value) && value > 0)
+          {
+               digits |= SUDOKU_TEST_FLAG_SHIFT(value);
+          }
+          else
+          {
+               status = SUDOKU_COMMAND_USAGE;
+          }
+     }
+
+     if (status == SUDOKU_COMMAND_SUCCESS && digits == 0)
+     {
+          puts("No digits provided for the pencil marks");
+          status = SUDOKU_COMMAND_USAGE;
+     }
+
+     if (status == SUDOKU_COMMAND_SUCCESS)
+     {
+          if (board->contents[row][column] != 0)
+          {
+               printf("Sorry, square %c%d is already filled\n", colLabels[column], row + 1);
+               status = SUDOKU_COMMAND_FAILURE;
+          }
+          else if (isMarking && (digits & ~board->candidates[row][column]))
+          {
+               printf("Sorry, square %c%d shares a row, column or block with a digit being marked\n",
+                    colLabels[column], row + 1);
+               status = SUDOKU_COMMAND_FAILURE;
+          }
+          else
+          {
+               if (isMarking)
+               {
+                    board->crossedOut[row][column] &= ~digits;
+               }
+               else
+               {
+                    board->crossedOut[row][column] |= digits;
+               }
+
+               printf("Square %c%d now has %d pencil marks\n\n", colLabels[column], row + 1,
+                    countDigitFlags(SUDOKU_PENCIL_MARKS(board, row, column)));
+
+               if (IS_INTERACTIVE(input))
+               {
+                    printSudokuBoardCandidates(board);
+               }
+          }
+     }
+
+     return status;
+}
+
 SudokuCommandResult commandUndo(SudokuBoard *board, SudokuCommandInput *input)
 {
      SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
@@ -371,8 +732,11 @@ SudokuCommandResult commandUndo(SudokuBoard *board, SudokuCommandInput *input)
      if (undoStep(board->history, stepsToUndo))
      {
           // display new state of board
-          putchar('\n');
-          printSudokuBoard(board);
+          if (IS_INTERACTIVE(input))
+          {
+               putchar('\n');
+               printSudokuBoard(board);
+          }
      }
      else
      {
@@ -398,8 +762,11 @@ SudokuCommandResult commandRedo(SudokuBoard *board, SudokuCommandInput *input)
      if (redoStep(board->history, stepsToRedo))
      {
           // display new state of board
-          putchar('\n');
-          printSudokuBoard(board);
+          if (IS_INTERACTIVE(input))
+          {
+               putchar('\n');
+               printSudokuBoard(board);
+          }
      }
      else
      {
@@ -410,6 +777,92 @@ SudokuCommandResult commandRedo(SudokuBoard *board, SudokuCommandInput *input)
      return status;
 }
 
+SudokuCommandResult commandGoto(SudokuBoard *board, SudokuCommandInput *input)
+{
+     SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
+     unsigned step;
+
+     // the step is required; there is no sensible default
+     if (getUnsignedArgument(input, &step))
+     {
+          if (gotoHistoryStep(board->history, step))
+          {
+               printf("Board is now at step %u\n\n", step);
+               if (IS_INTERACTIVE(input))
+               {
+                    printSudokuBoard(board);
+               }
+          }
+          else
+          {
+               // specific error message provided by gotoHistoryStep
+               status = SUDOKU_COMMAND_FAILURE;
+          }
+     }
+     else
+     {
+          status = SUDOKU_COMMAND_USAGE;
+     }
+
+     return status;
+}
+
+SudokuCommandResult commandHistory(SudokuBoard *board, SudokuCommandInput *input)
+{
+     size_t currentStep, length, checkpointCount, checkpointInterval;
+     unsigned interval;
+
+     // if a new interval was provided, rebuild the checkpoints before reporting them
+     if (getUnsignedArgument(input, &interval) && interval > 0)
+     {
+          setHistoryCheckpointInterval(board->history, interval);
+     }
+
+     getHistoryPosition(board->history, &currentStep, &length, &checkpointCount, &checkpointInterval);
+
+     printf("At step %lu of %lu, with a checkpoint every %lu steps (%lu checkpoints, %lu bytes)\n",
+          (unsigned long) currentStep, (unsigned long) length, (unsigned long) checkpointInterval,
+          (unsigned long) checkpointCount, (unsigned long) (checkpointCount * SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT));
+
+     return SUDOKU_COMMAND_SUCCESS;
+}
+
+SudokuCommandResult commandBranches(SudokuBoard *board, SudokuCommandInput *input)
+{
+     listHistoryBranches(board->history);
+
+     return SUDOKU_COMMAND_SUCCESS;
+}
+
+SudokuCommandResult commandBranch(SudokuBoard *board, SudokuCommandInput *input)
+{
+     SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
+     unsigned branch;
+
+     if (getUnsignedArgument(input, &branch) && branch > 0)
+     {
+          if (switchHistoryBranch(board->history, branch))
+          {
+               printf("Switched to branch %u\n\n", branch);
+               if (IS_INTERACTIVE(input))
+               {
+                    printSudokuBoard(board);
+               }
+          }
+          else
+          {
+               // specific error message provided by switchHistoryBranch
+               status = SUDOKU_COMMAND_FAILURE;
+          }
+     }
+     else
+     {
+          status = SUDOKU_COMMAND_USAGE;
+     }
+
+     return status;
+}
+
 SudokuCommandResult commandHelp(SudokuBoard *board, SudokuCommandInput *input)
 {
      SudokuCommandResult status = SUDOKU_COMMAND_SUCCESS;
@@ -454,108 +907,128 @@ SudokuCommandResult commandCommands(SudokuBoard * board, SudokuCommandInput * in
      return SUDOKU_COMMAND_SUCCESS;
 }
 
-inline char getCharFromInputString(SudokuCommandInput *input)
+/**
+ * Splits the line in a SudokuCommandInput into whitespace-separated tokens, once, so arguments
+ * can be read without copying or re-scanning it. Tokens point into the line itself. A line with
+ * more than SUDOKU_COMMAND_TOKEN_MAX tokens is flagged as too long, rather than being cut short.
+ *
+ * @param input Command input, holding a freshly-read line
+ */
+void tokenizeCommandInput(SudokuCommandInput *input)
 {
-     char ch = PEEK_CHAR_FROM_INPUT_STRING_AT_INDEX(input, input->currentIndex);
-     
-     if (ch)
+     const char *ch;
+
+     if (input == NULL || input->string.array == NULL)
      {
-          // Only increment current index if received char is not null
-          ++(input->currentIndex);
+          terminate("ERROR: tried to split an invalid SudokuCommandInput");
      }
 
-     return ch;
-}
+     input->tokenCount = 0;
+     input->currentToken = 0;
+     input->currentOffset = 0;
+     input->isTooLong = false;
 
-bool validateCommandInputStartStatus(SudokuCommandInput *input)
-{
-     bool status = true;
-     
-     if (input)
+     for (ch = input->string.array; *ch && !input->isTooLong; )
      {
-          // if the string's array is not NULL and it contains characters
-          if (input->string.array && input->string.length > 0)
+          // skip the whitespace before the next token
+          while (isspace((unsigned char) *ch))
           {
-               // if there no more input to read
-               if (!IS_ANY_INPUT_REMAINING(input))
-               {
-                    // 'input' cannot be read from, because there are no more chars remaining
-                    status = false;
-               }
+               ++ch;
           }
-          else
+
+          if (*ch && input->tokenCount == SUDOKU_COMMAND_TOKEN_MAX)
           {
-               terminate("ERROR: tried to get string argument from an invalid String");
+               input->isTooLong = true;
+          }
+          else if (*ch)
+          {
+               SudokuCommandToken *token = &input->tokens[input->tokenCount++];
+
+               token->start = ch;
+
+               while (*ch && !isspace((unsigned char) *ch))
+               {
+                    ++ch;
+               }
+
+               token->length = (size_t) (ch - token->start);
           }
      }
-     else
+}
+
+/**
+ * Takes the rest of the current token as an argument. If single characters were already taken
+ * from the token (see getCharArgument), only the characters after them are part of the argument.
+ *
+ * @param input Command input, already split by tokenizeCommandInput
+ * @param start Receives a pointer to the argument's first character, inside the input line
+ * @param length Receives the number of characters in the argument
+ * @return False if there are no arguments left
+ */
+bool getTokenArgument(SudokuCommandInput *input, const char **start, size_t *length)
+{
+     bool status = IS_ANY_INPUT_REMAINING(input);
+
+     if (status)
      {
-          terminate("ERROR: tried to get string argument from a null SudokuCommandInput");
+          const SudokuCommandToken *token = &input->tokens[input->currentToken++];
+
+          *start = token->start + input->currentOffset;
+          *length = token->length - input->currentOffset;
+          input->currentOffset = 0;
      }
 
      return status;
 }
 
-void seekToNextArgument(SudokuCommandInput *input, bool discardRestOfCurrentArgument)
+/**
+ * Takes a single character as an argument. Characters are taken from inside a token if they're
+ * run together, so "change E68", "change E6 8" and "change E 6 8" are all read the same way.
+ *
+ * @param input Command input, already split by tokenizeCommandInput
+ * @param argument Receives the character
+ * @return False if there are no arguments left
+ */
+bool getCharArgument(SudokuCommandInput *input, char *argument)
 {
-     int startIndex = input->currentIndex;
-     
-     // start with char right before currentIndex if discardRestOfCurrentArgument is true.
-     // this checks if currentIndex is already the start of a new argument or not
-     if (discardRestOfCurrentArgument && input->currentIndex != 0)
-     {
-          startIndex = input->currentIndex - 1;
-     }
+     bool status = IS_ANY_INPUT_REMAINING(input);
 
-     char ch = PEEK_CHAR_FROM_INPUT_STRING_AT_INDEX(input, startIndex);
-     
-     // skip to the end of current argument, if any non-space characters remain
-     while (discardRestOfCurrentArgument &&
-            !isspace(ch) && ch != 0)
+     if (status)
      {
-          ch = getCharFromInputString(input);
-     }
+          const SudokuCommandToken *token = &input->tokens[input->currentToken];
 
-     // skip the whitespace until next argument
-     while (isspace(ch))
-     {
-          ch = getCharFromInputString(input);
-     }
+          *argument = token->start[input->currentOffset++];
 
-     // if final char fetched is a valid input char, put it "back" into the input string
-     if (discardRestOfCurrentArgument && !isspace(ch))
-     {
-          --(input->currentIndex);
+          // move on to the next token once this one is used up
+          if (input->currentOffset == token->length)
+          {
+               ++input->currentToken;
+               input->currentOffset = 0;
+          }
      }
+
+     return status;
 }
 
 bool getStringArgument(SudokuCommandInput * input, char * argument, size_t maxLength)
 {
-     bool status = true;
-     
-     // maxLength gets 1 subtracted from it in the loop (to leave room for null-terminator)
-     // this will cause unsigned overflow it maxLength == 0
-     if (maxLength > 0 && validateCommandInputStartStatus(input))
-     {
-          size_t i = 0; // for comparison with maxLength, i should be unsigned type
-          char ch;
+     bool status = false;
+     const char *start;
+     size_t length;
 
-          // Compare i with one less than maxLength to allow room for null terminator
-          while (i < maxLength - 1 &&
-                 (ch = getCharFromInputString(input)) && 
-                 !isspace(ch))
+     // maxLength has 1 subtracted from it below (to leave room for null-terminator)
+     if (maxLength > 0 && getTokenArgument(input, &start, &length))
+     {
+          // arguments too long for 'argument' are cut short
+          if (length > maxLength - 1)
           {
-               argument[i++] = ch;
+               length = maxLength - 1;
           }
 
-          // null-terminate the argument
-          argument[i] = 0;
+          memcpy(argument, start, length);
+          argument[length] = 0;
 
-          seekToNextArgument(input, true);
-     }
-     else
-     {
-          status = false;
+          status = true;
      }
 
      return status;
@@ -563,31 +1036,24 @@ bool getStringArgument(SudokuCommandInput * input, char * argument, size_t maxLe
 
 bool getUnsignedArgument(SudokuCommandInput * input, unsigned * argument)
 {
-     bool status = true;
-     
-     if (validateCommandInputStartStatus(input))
-     {
-          String numberCharacters = { 0 };
-          initializeString(&numberCharacters);
-
-          int ch;
+     bool status;
+     const char *start;
+     size_t length, i;
 
-          while ((ch = getCharFromInputString(input)) && !isspace(ch) && isdigit(ch))
-          {
-               addCharToString(&numberCharacters, ch);
-          }
+     status = getTokenArgument(input, &start, &length);
 
-          // convert the digit characters read into numeric form
+     if (status)
+     {
+          // the number is read straight out of the input line, up to the first non-digit.
           // because we read only digits, number should never be negative
-          *argument = (unsigned)atoi(numberCharacters.array);
+          *argument = 0;
 
-          // NOTE: if conversion fails, *argument == 0
+          for (i = 0; i < length && isdigit((unsigned char) start[i]); ++i)
+          {
+               *argument = *argument * 10 + (unsigned) (start[i] - '0');
+          }
 
-          seekToNextArgument(input, true);
-     }
-     else
-     {
-          status = false;
+          // NOTE: if the argument doesn't start with a digit, *argument == 0
      }
 
      return status;
@@ -599,19 +1065,14 @@ bool getUnsignedArgument(SudokuCommandInput * input, unsigned * argument)
 bool getColumnArgument(SudokuCommandInput * input, char *argument)
 {
      bool status = true;
-     
-     
-     if (validateCommandInputStartStatus(input))
-     {
-          *argument = getCharFromInputString(input);
 
+     if (getCharArgument(input, argument))
+     {
           // turn ASCII code into integer value
           *argument = SUDOKU_COL_LETTER_TO_INDEX(*argument);
 
           // is argument in range [0, 8] (inclusive)?
           status = validateColIndex(*argument);
-
-          seekToNextArgument(input, false);
      }
      else
      {
@@ -626,17 +1087,13 @@ bool getRowArgument(SudokuCommandInput * input, char * argument)
 {
      bool status = true;
 
-     if (validateCommandInputStartStatus(input))
+     if (getCharArgument(input, argument))
      {
-          *argument = getCharFromInputString(input);
-
           // turn ASCII code into integer value
           *argument = SUDOKU_ROW_NUMBER_TO_INDEX(*argument);
 
           // is argument inside range [0, 8] (inclusive)?
           status = validateRowIndex(*argument);
-
-          seekToNextArgument(input, false);
      }
      else
      {
@@ -651,17 +1108,13 @@ bool getSudokuDigitArgument(SudokuCommandInput * input, char * argument)
 {
      bool status = true;
 
-     if (validateCommandInputStartStatus(input))
+     if (getCharArgument(input, argument))
      {
-          *argument = getCharFromInputString(input);
-
           // turn ASCII code into integer value
           *argument = SUDOKU_DIGIT_CHAR_TO_VALUE(*argument);
 
           // is argument in range [0, 9] (inclusive)?
           status = validateSudokuDigit(*argument);
-
-          seekToNextArgument(input, false);
      }
      else
      {
@@ -684,42 +1137,112 @@ void printCommands()
      }
 }
 
-const struct SudokuCommand *getCommand(SudokuCommandInput *input)
+/**
+ * Reads the next command from a script: blank lines and lines starting with '#' are skipped,
+ * and unknown commands are reported with their line number, then skipped as well.
+ *
+ * @param input Command input, with 'script' set
+ * @return The command, or NULL when the script has no lines left
+ */
+const struct SudokuCommand *getScriptCommand(SudokuCommandInput *input)
 {
      const struct SudokuCommand *command = NULL;
+     char commandName[SUDOKU_COMMAND_NAME_LENGTH_MAX];
+     bool endOfScript = false;
 
-     do
+     while (!command && !endOfScript)
      {
-          char commandName[SUDOKU_COMMAND_NAME_LENGTH_MAX];
-          
           clearString(&input->string);
-          input->currentIndex = 0;
-          ensureCleanInput();
 
-          fputs("Enter command: ", stdout);
-          readString(&input->string);
-          putchar('\n');
-
-          if (getStringArgument(input, commandName, SUDOKU_COMMAND_NAME_LENGTH_MAX))
+          if (readStringLine(&input->string, input->script) == EOF)
           {
-               command = matchCommand(commandName);
+               endOfScript = true;
           }
-
-          // command will be null if getCommandNameArgument failed OR if no match was found
-          if (!command)
+          else
           {
-               printf("'%s' is not a valid command. \n%s\n\n", commandName, showAllCommandsPrompt);
+               ++input->lineNumber;
+               tokenizeCommandInput(input);
+
+               if (getStringArgument(input, commandName, SUDOKU_COMMAND_NAME_LENGTH_MAX) && commandName[0] != '#')
+               {
+                    if (!(command = matchCommand(commandName)))
+                    {
+                         printf("line %lu: '%s' is not a valid command\n", input->lineNumber, commandName);
+                         ++input->errorCount;
+                    }
+               }
           }
-          
-     } while (!command);
+     }
 
      return command;
 }
 
+const struct SudokuCommand *getCommand(SudokuCommandInput *input)
+{
+     const struct SudokuCommand *command = NULL;
+
+     // scripts are read line by line, with no prompting and no second chances
+     if (!IS_INTERACTIVE(input))
+     {
+          command = getScriptCommand(input);
+     }
+     else
+     {
+          do
+          {
+               char commandName[SUDOKU_COMMAND_NAME_LENGTH_MAX];
+
+               clearString(&input->string);
+               ensureCleanInput();
+
+               fputs("Enter command: ", stdout);
+               readString(&input->string);
+               putchar('\n');
+
+               tokenizeCommandInput(input);
+
+               if (getStringArgument(input, commandName, SUDOKU_COMMAND_NAME_LENGTH_MAX))
+               {
+                    command = matchCommand(commandName);
+               }
+
+               // command will be null if getCommandNameArgument failed OR if no match was found
+               if (!command)
+               {
+                    printf("'%s' is not a valid command. \n%s\n\n", commandName, showAllCommandsPrompt);
+               }
+
+          } while (!command);
+     }
+
+     return command;
+}
+
+/**
+ * Finds a command by its name, or by any abbreviation of its name that no other command shares
+ * (e.g. "che" for "check", but not "ch", which could also be "change")
+ *
+ * @param name Name to look for
+ * @return The command, or NULL if there is none, or the abbreviation fits more than one
+ */
 const struct SudokuCommand *matchCommand(char *name)
+{
+     int index;
+
+     runSudokuOnce(&commandNameTableOnce, buildCommandNameTable);
+     index = lookupSudokuName(&commandNameTable, name);
+
+     return index >= 0 ? &commands[index] : NULL;
+}
+
+/**
+ * The way commands used to be found: compare the name with each command's in turn. Kept only
+ * so runDispatchBenchmark has something to measure matchCommand against.
+ */
+const struct SudokuCommand *matchCommandLinear(char *name)
 {
      const struct SudokuCommand *command = NULL;
-     int i;
+     size_t i;
 
      for (i = 0; !command && i < SUDOKU_COMMAND_COUNT; ++i)
      {
@@ -731,3 +1254,62 @@ const struct SudokuCommand *matchCommand(char *name)
 
      return command;
 }
+
+/**
+ * Times looking up every command by name, with matchCommand and with a linear search
+ *
+ * @param iterations Number of times to look up every command with each method
+ * @return Exit code for the program
+ */
+int runDispatchBenchmark(unsigned long iterations)
+{
+     const struct SudokuCommand *volatile found = NULL;
+     char names[SUDOKU_COMMAND_COUNT][SUDOKU_COMMAND_NAME_LENGTH_MAX];
+     unsigned long i;
+     clock_t start;
+     double linearSeconds, hashedSeconds;
+     size_t j;
+
+     // copy the names, so neither method can get away with comparing pointers
+     for (j = 0; j < SUDOKU_COMMAND_COUNT; ++j)
+     {
+          strcpy(names[j], commands[j].name);
+     }
+
+     // build the table before the clock starts
+     matchCommand(names[0]);
+
+     start = clock();
+
+     for (i = 0; i < iterations; ++i)
+     {
+          for (j = 0; j < SUDOKU_COMMAND_COUNT; ++j)
+          {
+               found = matchCommandLinear(names[j]);
+          }
+     }
+
+     linearSeconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+     start = clock();
+
+     for (i = 0; i < iterations; ++i)
+     {
+          for (j = 0; j < SUDOKU_COMMAND_COUNT; ++j)
+          {
+               found = matchCommand(names[j]);
+          }
+     }
+
+     hashedSeconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+     // 'found' is only there so the lookups can't be optimized away
+     (void) found;
+
+     printf("%lu lookups of each of %d commands\n", iterations, (int) (SUDOKU_COMMAND_COUNT));
+     printf("   linear search: %.3f s (%.1f ns per lookup)\n", linearSeconds,
+          linearSeconds * 1e9 / ((double) iterations * (SUDOKU_COMMAND_COUNT)));
+     printf("   hash table:    %.3f s (%.1f ns per lookup)\n", hashedSeconds,
+          hashedSeconds * 1e9 / ((double) iterations * (SUDOKU_COMMAND_COUNT)));
+
+     return 0;
+}
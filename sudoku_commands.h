@@ -2,12 +2,22 @@
 #define SUDOKU_COMMANDS_H
 
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "sudoku_board.h"
 #include "sudoku_utility.h"
 
 #define SUDOKU_COMMAND_NAME_LENGTH_MAX 16
 
+/** number of times --benchmark-dispatch looks up each command, unless told otherwise */
+#define SUDOKU_DISPATCH_BENCHMARK_ITERATIONS 1000000
+
+/** size of the buffer scripts are read through */
+#define SUDOKU_SCRIPT_BUFFER_SIZE 65536
+
+/** scripts get no prompts and no board printouts, unless they ask for one with 'display' */
+#define IS_INTERACTIVE(inputPtr) ((inputPtr)->script == NULL)
+
 enum SudokuCommandResult {
      SUDOKU_COMMAND_SUCCESS,
      SUDOKU_COMMAND_USAGE,
@@ -16,10 +26,33 @@ enum SudokuCommandResult {
 };
 typedef enum SudokuCommandResult SudokuCommandResult;
 
+/** most arguments (including the command name) a line is split into, enough for the longest
+    command line: 'mark A 1' followed by all nine digits */
+#define SUDOKU_COMMAND_TOKEN_MAX 12
+
+/**
+ * One whitespace-separated word of a command line. It points into the line, rather than being
+ * copied out of it.
+ */
+struct SudokuCommandToken
+{
+     const char *start;   /**< first character of the token, inside the input line */
+     size_t length;       /**< number of characters in the token (it isn't null-terminated) */
+};
+
+typedef struct SudokuCommandToken SudokuCommandToken;
+
 struct SudokuCommandInput
 {
      String string;
-     size_t currentIndex;
+     SudokuCommandToken tokens[SUDOKU_COMMAND_TOKEN_MAX];  /**< the line, split once when read */
+     size_t tokenCount;         /**< number of elements of 'tokens' in use */
+     bool isTooLong;            /**< the line had more than SUDOKU_COMMAND_TOKEN_MAX tokens */
+     size_t currentToken;       /**< next token to be read as an argument */
+     size_t currentOffset;      /**< characters of the current token already read one at a time */
+     FILE *script;              /**< commands are read from this stream, without prompting, or NULL */
+     unsigned long lineNumber;  /**< line of 'script' the current command was read from */
+     unsigned long errorCount;  /**< number of script lines that failed */
 };
 
 typedef struct SudokuCommandInput SudokuCommandInput;
@@ -57,4 +90,6 @@ const struct SudokuCommand *getCommand(SudokuCommandInput *input);
 
 const struct SudokuCommand *matchCommand(char *name);
 
+int runDispatchBenchmark(unsigned long iterations);
+
 #endif // !SUDOKU_COMMANDS_H
\ No newline at end of file
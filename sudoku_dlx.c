@@ -0,0 +1,337 @@
+/******************************************************************************
+ * Program: sudoku_dlx.c
+ *
+ * Purpose: Exact-cover solver engine for sudoku boards, using Knuth's
+ *          Algorithm X with the "Dancing Links" technique
+ *
+ *****************************************************************************/
+#include <memory.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "sudoku_board.h"
+#include "sudoku_dlx.h"
+#include "sudoku_undo.h"
+#include "sudoku_utility.h"
+
+/*
+ * ======= EXACT COVER MODEL =======
+ * Every possible placement (row, column, digit) is a row of the matrix: 9 x 9 x 9 = 729 rows.
+ * Every rule a solved board must satisfy is a column of the matrix: 4 x 81 = 324 columns.
+ *   -   0 to  80: each square holds exactly one digit
+ *   -  81 to 161: each row holds each digit exactly once
+ *   - 162 to 242: each column holds each digit exactly once
+ *   - 243 to 323: each block holds each digit exactly once
+ * A placement satisfies exactly 4 rules, so every matrix row has exactly 4 nodes.
+ *
+ * Nodes live in one fixed-size array and link to each other by index instead of by pointer,
+ * so the whole matrix sits in a single block of stack memory: a solve does no heap allocation.
+ * Node 0 is the root, nodes 1 to 324 are the column headers, and the rest are placement nodes.
+ */
+#define SUDOKU_DLX_CONSTRAINT_COUNT (4 * SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT)
+#define SUDOKU_DLX_PLACEMENT_COUNT (SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT * SUDOKU_DIGIT_MAX)
+#define SUDOKU_DLX_FIRST_PLACEMENT_NODE (1 + SUDOKU_DLX_CONSTRAINT_COUNT)
+#define SUDOKU_DLX_NODE_COUNT (SUDOKU_DLX_FIRST_PLACEMENT_NODE + 4 * SUDOKU_DLX_PLACEMENT_COUNT)
+#define SUDOKU_DLX_ROOT 0
+
+/** index of the first node belonging to a placement */
+#define SUDOKU_DLX_PLACEMENT_NODE(placement) (SUDOKU_DLX_FIRST_PLACEMENT_NODE + 4 * (placement))
+/** which placement a node belongs to */
+#define SUDOKU_DLX_NODE_PLACEMENT(node) (((node) - SUDOKU_DLX_FIRST_PLACEMENT_NODE) / 4)
+
+/**
+ * The sparse exact-cover matrix, as a set of parallel arrays of node links
+ */
+struct SudokuDlxMatrix {
+     short left[SUDOKU_DLX_NODE_COUNT];
+     short right[SUDOKU_DLX_NODE_COUNT];
+     short up[SUDOKU_DLX_NODE_COUNT];
+     short down[SUDOKU_DLX_NODE_COUNT];
+     short header[SUDOKU_DLX_NODE_COUNT];  /**< column header that each node belongs to */
+     short size[1 + SUDOKU_DLX_CONSTRAINT_COUNT]; /**< number of nodes remaining in each column */
+     short solution[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT]; /**< placements chosen by the search */
+     int depth;                                           /**< number of placements chosen */
+};
+
+typedef struct SudokuDlxMatrix SudokuDlxMatrix;
+
+
+void initializeDlxMatrix(SudokuDlxMatrix *matrix);
+void coverDlxColumn(SudokuDlxMatrix *matrix, int header);
+void uncoverDlxColumn(SudokuDlxMatrix *matrix, int header);
+bool selectDlxPlacement(SudokuDlxMatrix *matrix, int placement);
+bool searchDlxMatrix(SudokuDlxMatrix *matrix, SudokuSolverStats *stats);
+
+
+/**
+ * Finds a complete solution for a sudoku board using Dancing Links. The board itself is not
+ * modified; instead, the changes needed to solve it are returned as HistorySteps, in the order
+ * the search chose them.
+ *
+ * @param contents Board contents to solve (0 for blank squares)
+ * @param steps Receives one HistoryStep for each blank square
+ * @param stepCount Receives the number of HistorySteps written to 'steps'
+ * @param stats Optional counters for the work done by the search (may be NULL)
+ * @return True if a solution was found, false if the board cannot be solved
+ */
+bool solveSudokuBoardDlx(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT],
+     HistoryStep steps[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT], size_t *stepCount, SudokuSolverStats *stats)
+{
+     SudokuDlxMatrix matrix;
+     SudokuSolverStats localStats = { 0 };
+     bool solved = true;
+     int row, column, digit, i;
+
+     if (stats == NULL)
+     {
+          stats = &localStats;
+     }
+
+     stats->nodes = 0;
+     stats->backtracks = 0;
+     *stepCount = 0;
+
+     initializeDlxMatrix(&matrix);
+
+     // squares that are already filled are placements the search doesn't get to choose
+     for (row = 0; solved && row < SUDOKU_ROW_COUNT; ++row)
+     {
+          for (column = 0; solved && column < SUDOKU_COL_COUNT; ++column)
+          {
+               digit = contents[row][column];
+
+               if (digit < 0 || digit > SUDOKU_DIGIT_MAX)
+               {
+                    solved = false;
+               }
+               else if (digit > 0)
+               {
+                    solved = selectDlxPlacement(&matrix,
+                         (row * SUDOKU_COL_COUNT + column) * SUDOKU_DIGIT_MAX + digit - 1);
+               }
+          }
+     }
+
+     // given squares are recorded in the solution too, but they aren't changes
+     matrix.depth = 0;
+
+     if (solved && searchDlxMatrix(&matrix, stats))
+     {
+          for (i = 0; i < matrix.depth; ++i)
+          {
+               int placement = matrix.solution[i],
+                   square = placement / SUDOKU_DIGIT_MAX;
+
+               steps[i].location.row = square / SUDOKU_COL_COUNT;
+               steps[i].location.col = square % SUDOKU_COL_COUNT;
+               steps[i].newValue = placement % SUDOKU_DIGIT_MAX + 1;
+               steps[i].oldValue = 0;
+          }
+
+          *stepCount = matrix.depth;
+     }
+     else
+     {
+          solved = false;
+     }
+
+     return solved;
+}
+
+/**
+ * Links up the full matrix: every placement is possible and no column is covered yet
+ */
+void initializeDlxMatrix(SudokuDlxMatrix *matrix)
+{
+     int header, placement, node, i;
+
+     // root and column headers form one horizontal ring; each header starts as an empty column
+     for (header = 0; header <= SUDOKU_DLX_CONSTRAINT_COUNT; ++header)
+     {
+          matrix->left[header] = header == 0 ? SUDOKU_DLX_CONSTRAINT_COUNT : header - 1;
+          matrix->right[header] = header == SUDOKU_DLX_CONSTRAINT_COUNT ? 0 : header + 1;
+          matrix->up[header] = header;
+          matrix->down[header] = header;
+          matrix->header[header] = header;
+          matrix->size[header] = 0;
+     }
+
+     for (placement = 0; placement < SUDOKU_DLX_PLACEMENT_COUNT; ++placement)
+     {
+          int square = placement / SUDOKU_DIGIT_MAX,
+              digit = placement % SUDOKU_DIGIT_MAX,
+              row = square / SUDOKU_COL_COUNT,
+              column = square % SUDOKU_COL_COUNT,
+              block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column),
+              headers[4];
+
+          // column headers are numbered from 1, because node 0 is the root
+          headers[0] = 1 + square;
+          headers[1] = 1 + 81 + row * SUDOKU_DIGIT_MAX + digit;
+          headers[2] = 1 + 162 + column * SUDOKU_DIGIT_MAX + digit;
+          headers[3] = 1 + 243 + block * SUDOKU_DIGIT_MAX + digit;
+
+          for (i = 0; i < 4; ++i)
+          {
+               node = SUDOKU_DLX_PLACEMENT_NODE(placement) + i;
+               header = headers[i];
+
+               // the placement's 4 nodes form their own horizontal ring
+               matrix->left[node] = SUDOKU_DLX_PLACEMENT_NODE(placement) + (i + 3) % 4;
+               matrix->right[node] = SUDOKU_DLX_PLACEMENT_NODE(placement) + (i + 1) % 4;
+
+               // append node to the bottom of its column
+               matrix->header[node] = header;
+               matrix->up[node] = matrix->up[header];
+               matrix->down[node] = header;
+               matrix->down[matrix->up[header]] = node;
+               matrix->up[header] = node;
+               ++matrix->size[header];
+          }
+     }
+
+     matrix->depth = 0;
+}
+
+/**
+ * Removes a column from the header ring, along with every placement that would also satisfy it
+ */
+void coverDlxColumn(SudokuDlxMatrix *matrix, int header)
+{
+     int i, j;
+
+     matrix->right[matrix->left[header]] = matrix->right[header];
+     matrix->left[matrix->right[header]] = matrix->left[header];
+
+     for (i = matrix->down[header]; i != header; i = matrix->down[i])
+     {
+          for (j = matrix->right[i]; j != i; j = matrix->right[j])
+          {
+               matrix->down[matrix->up[j]] = matrix->down[j];
+               matrix->up[matrix->down[j]] = matrix->up[j];
+               --matrix->size[matrix->header[j]];
+          }
+     }
+}
+
+/**
+ * Exact reverse of coverDlxColumn. Must be called in the opposite order of the covers.
+ */
+void uncoverDlxColumn(SudokuDlxMatrix *matrix, int header)
+{
+     int i, j;
+
+     for (i = matrix->up[header]; i != header; i = matrix->up[i])
+     {
+          for (j = matrix->left[i]; j != i; j = matrix->left[j])
+          {
+               ++matrix->size[matrix->header[j]];
+               matrix->down[matrix->up[j]] = j;
+               matrix->up[matrix->down[j]] = j;
+          }
+     }
+
+     matrix->right[matrix->left[header]] = header;
+     matrix->left[matrix->right[header]] = header;
+}
+
+/**
+ * Commits to a placement given by the board, covering all 4 of its columns
+ *
+ * @return False if any of those columns was already covered (the board repeats a digit)
+ */
+bool selectDlxPlacement(SudokuDlxMatrix *matrix, int placement)
+{
+     bool valid = true;
+     int first = SUDOKU_DLX_PLACEMENT_NODE(placement), node = first;
+
+     do
+     {
+          int header = matrix->header[node];
+
+          // a covered column has been unlinked from its neighbors
+          if (matrix->right[matrix->left[header]] != header)
+          {
+               valid = false;
+          }
+          else
+          {
+               coverDlxColumn(matrix, header);
+          }
+
+          node = matrix->right[node];
+     } while (valid && node != first);
+
+     if (valid)
+     {
+          matrix->solution[matrix->depth++] = placement;
+     }
+
+     return valid;
+}
+
+/**
+ * Algorithm X: pick the column with the fewest remaining placements and try each one in turn
+ *
+ * @return True once every column is covered; the matrix's 'solution' then holds the answer
+ */
+bool searchDlxMatrix(SudokuDlxMatrix *matrix, SudokuSolverStats *stats)
+{
+     bool solved = false;
+     int header, node, j, best;
+
+     // no columns left means every rule is satisfied
+     if (matrix->right[SUDOKU_DLX_ROOT] == SUDOKU_DLX_ROOT)
+     {
+          solved = true;
+     }
+     else
+     {
+          best = matrix->right[SUDOKU_DLX_ROOT];
+
+          for (header = matrix->right[best]; header != SUDOKU_DLX_ROOT; header = matrix->right[header])
+          {
+               if (matrix->size[header] < matrix->size[best])
+               {
+                    best = header;
+               }
+          }
+
+          // an empty column is a rule nothing can satisfy anymore, so this branch is dead
+          if (matrix->size[best] > 0)
+          {
+               coverDlxColumn(matrix, best);
+
+               for (node = matrix->down[best]; !solved && node != best; node = matrix->down[node])
+               {
+                    ++stats->nodes;
+                    matrix->solution[matrix->depth++] = SUDOKU_DLX_NODE_PLACEMENT(node);
+
+                    for (j = matrix->right[node]; j != node; j = matrix->right[j])
+                    {
+                         coverDlxColumn(matrix, matrix->header[j]);
+                    }
+
+                    solved = searchDlxMatrix(matrix, stats);
+
+                    if (!solved)
+                    {
+                         for (j = matrix->left[node]; j != node; j = matrix->left[j])
+                         {
+                              uncoverDlxColumn(matrix, matrix->header[j]);
+                         }
+
+                         --matrix->depth;
+                         ++stats->backtracks;
+                    }
+               }
+
+               if (!solved)
+               {
+                    uncoverDlxColumn(matrix, best);
+               }
+          }
+     }
+
+     return solved;
+}
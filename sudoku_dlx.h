@@ -0,0 +1,15 @@
+#ifndef SUDOKU_DLX_H
+#define SUDOKU_DLX_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "sudoku_board.h"
+#include "sudoku_solver.h"
+#include "sudoku_undo.h"
+#include "sudoku_utility.h"
+
+bool solveSudokuBoardDlx(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT],
+     HistoryStep steps[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT], size_t *stepCount, SudokuSolverStats *stats);
+
+#endif // !SUDOKU_DLX_H
@@ -0,0 +1,381 @@
+/******************************************************************************
+ * Program: sudoku_generator.c
+ *
+ * Purpose: Generates random sudoku puzzles with a unique solution, graded by
+ *          which stages of the assistant pipeline are needed to solve them
+ *
+ *****************************************************************************/
+#include <memory.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sudoku_assistant.h"
+#include "sudoku_batch.h"
+#include "sudoku_board.h"
+#include "sudoku_generator.h"
+#include "sudoku_parallel.h"
+#include "sudoku_solver.h"
+#include "sudoku_test_digits.h"
+#include "sudoku_utility.h"
+
+/** how many random grids to try before giving up on reaching the requested difficulty */
+#define SUDOKU_GENERATOR_ATTEMPTS_MAX 1000
+
+/**
+ * A puzzle's grade is the position (from 1) of the costliest stage of the assistant pipeline
+ * (see sudokuPipelineNames) it needs, or one past the last stage if the pipeline can't solve it
+ */
+const SudokuDifficulty sudokuDifficulties[] = {
+     { "easy", "Solvable by cross-hatching alone", 1 },
+     { "medium", "Also needs locked candidates", 2 },
+     { "hard", "Also needs naked or hidden subsets", 3 },
+     { "expert", "Also needs fish (X-wing, swordfish or jellyfish)", 4 },
+     { "fiendish", "Also needs chains", 5 },
+     { "extreme", "Beyond every assistant; needs trial and error", SUDOKU_PIPELINE_STAGE_COUNT + 1 },
+};
+
+#define SUDOKU_DIFFICULTY_COUNT sizeof(sudokuDifficulties)/sizeof(*sudokuDifficulties)
+
+/**
+ * Puzzles requested from the generator by 'runGenerate', and the results for each
+ */
+struct SudokuGenerateJob {
+     const SudokuDifficulty *difficulty;
+     unsigned long long seed;
+     char (*puzzles)[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     bool *isGenerated;          /**< false if no puzzle of the difficulty was found in time */
+};
+
+typedef struct SudokuGenerateJob SudokuGenerateJob;
+
+
+void fillRandomSolution(char solution[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], SudokuRandom *random);
+void shuffleSquares(unsigned char *squares, int count, SudokuRandom *random);
+bool isClueRemovable(const char puzzle[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], int square, int value,
+     const SudokuDifficulty *difficulty, SudokuBoard *scratchBoard);
+bool isHiddenSingle(const char puzzle[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], int square, int value);
+void generatePuzzleTask(void *shared, size_t taskIndex, SudokuBoard *workerBoard);
+
+
+/**
+ * Finds a difficulty by name
+ *
+ * @return Matching difficulty, or NULL if there is no difficulty with that name
+ */
+const SudokuDifficulty *matchDifficulty(const char *name)
+{
+     const SudokuDifficulty *difficulty = NULL;
+     size_t i;
+
+     for (i = 0; !difficulty && i < SUDOKU_DIFFICULTY_COUNT; ++i)
+     {
+          if (strcmp(name, sudokuDifficulties[i].name) == 0)
+          {
+               difficulty = &sudokuDifficulties[i];
+          }
+     }
+
+     return difficulty;
+}
+
+/**
+ * Seeds a random number generator. Nearby seeds (e.g. one per puzzle in a batch) are mixed
+ * (splitmix64), so they still produce unrelated sequences.
+ */
+void seedSudokuRandom(SudokuRandom *random, unsigned long long seed)
+{
+     seed += 0x9E3779B97F4A7C15ULL;
+     seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+     seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+     seed ^= seed >> 31;
+
+     // xorshift gets stuck at 0 forever
+     random->state = seed ? seed : 1;
+}
+
+/**
+ * Next pseudo-random number in the range [0, bound)
+ */
+unsigned nextSudokuRandom(SudokuRandom *random, unsigned bound)
+{
+     unsigned long long value;
+
+     random->state ^= random->state >> 12;
+     random->state ^= random->state << 25;
+     random->state ^= random->state >> 27;
+     value = random->state * 0x2545F4914F6CDD1DULL;
+
+     // scale the high 32 bits into range, which avoids a division
+     return (unsigned) (((value >> 32) * bound) >> 32);
+}
+
+/**
+ * Grades a puzzle by solving it with the assistant pipeline, which goes back to the simplest
+ * assistant after each step, so a harder one is only used when every simpler one is stuck.
+ * A puzzle the pipeline can solve has exactly one solution.
+ *
+ * @param contents Puzzle to grade
+ * @param scratchBoard Board to work on (its contents and History are replaced)
+ * @return Number of pipeline stages needed, or one more than the number of stages if the
+ *         pipeline can't solve the puzzle
+ */
+int gradeSudokuBoard(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], SudokuBoard *scratchBoard)
+{
+     SudokuPipeline pipeline;
+     SudokuAssistantResult result;
+     bool isFound = true;
+
+     initializeSudokuPipeline(&pipeline);
+
+     initializeSudokuBoard(scratchBoard);
+     memcpy(scratchBoard->contents, contents, sizeof(scratchBoard->contents));
+     refreshSudokuBoardDigits(scratchBoard);
+
+     while (isFound)
+     {
+          // eliminations aren't carried between calls, or a simpler assistant could lean on
+          // the work of a harder one and the puzzle would be graded too easy
+          clearSudokuAssistantResult(&result);
+
+          isFound = runSudokuPipeline(scratchBoard, &pipeline, &result) &&
+               applyAssistantPlacements(scratchBoard, &result, false) > 0;
+     }
+
+     return isSudokuSolutionValid(scratchBoard->contents) ? pipeline.hardestStage + 1 : SUDOKU_PIPELINE_STAGE_COUNT + 1;
+}
+
+/**
+ * Generates a random puzzle of the requested difficulty with exactly one solution.
+ * A random solution is made first, then clues are removed in random order, keeping each clue
+ * whose removal would make the puzzle harder than requested or give it a second solution.
+ * If the puzzle that's left is easier than requested, a new random solution is tried.
+ *
+ * @param puzzle Receives the puzzle
+ * @param difficulty Difficulty the puzzle must have
+ * @param random Random number generator
+ * @param scratchBoard Board used for grading (its contents and History are replaced)
+ * @return False if no puzzle of the difficulty was found after many attempts
+ */
+bool generateSudokuBoard(char puzzle[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], const SudokuDifficulty *difficulty,
+     SudokuRandom *random, SudokuBoard *scratchBoard)
+{
+     unsigned char squares[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT];
+     char *currentSquare = puzzle[0], value;
+     bool generated = false;
+     int attempt, i;
+
+     for (attempt = 0; !generated && attempt < SUDOKU_GENERATOR_ATTEMPTS_MAX; ++attempt)
+     {
+          fillRandomSolution(puzzle, random);
+
+          for (i = 0; i < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++i)
+          {
+               squares[i] = i;
+          }
+
+          shuffleSquares(squares, SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT, random);
+
+          for (i = 0; i < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++i)
+          {
+               value = currentSquare[squares[i]];
+               currentSquare[squares[i]] = 0;
+
+               if (!isClueRemovable(puzzle, squares[i], value, difficulty, scratchBoard))
+               {
+                    currentSquare[squares[i]] = value;
+               }
+          }
+
+          generated = gradeSudokuBoard(puzzle, scratchBoard) == difficulty->grade;
+     }
+
+     return generated;
+}
+
+/**
+ * Generates puzzles without any interaction, writing them to STDOUT one per line (the same
+ * format batch mode reads) and a summary to STDERR. Puzzles are generated on a pool of worker
+ * threads.
+ *
+ * @param count Number of puzzles to generate
+ * @param difficultyName Name of the difficulty every puzzle must have
+ * @param threadCount Number of worker threads (0 means one per processor)
+ * @return Exit status for the program
+ */
+int runGenerate(unsigned long count, const char *difficultyName, unsigned threadCount)
+{
+     int status = EXIT_SUCCESS;
+     SudokuGenerateJob job = { 0 };
+     unsigned long generatedCount = 0, i;
+     clock_t start = clock();
+
+     job.difficulty = matchDifficulty(difficultyName);
+
+     if (job.difficulty == NULL)
+     {
+          fprintf(stderr, "Sorry, \"%s\" is not a valid difficulty.\n", difficultyName);
+          status = EXIT_FAILURE;
+     }
+     else
+     {
+          job.seed = (unsigned long long) time(NULL);
+          job.puzzles = malloc(sizeof(*job.puzzles) * (count + 1));
+          job.isGenerated = malloc(sizeof(*job.isGenerated) * (count + 1));
+
+          if (!job.puzzles || !job.isGenerated)
+          {
+               terminate("ERROR: not enough memory to hold generated puzzles");
+          }
+
+          runSudokuTaskPool(count, threadCount, generatePuzzleTask, &job);
+
+          for (i = 0; i < count; ++i)
+          {
+               if (job.isGenerated[i])
+               {
+                    ++generatedCount;
+               }
+               else
+               {
+                    // keep the number of output lines equal to the number requested
+                    memset(job.puzzles[i], 0, sizeof(job.puzzles[i]));
+               }
+
+               writeSudokuBoardLine(job.puzzles[i], stdout);
+          }
+
+          fprintf(stderr, "Generated %lu of %lu %s puzzles (%.2f seconds of processor time)\n",
+               generatedCount, count, job.difficulty->name, (double) (clock() - start) / CLOCKS_PER_SEC);
+
+          free(job.puzzles);
+          free(job.isGenerated);
+     }
+
+     return status;
+}
+
+/**
+ * Fills a board with a random complete solution. The three blocks on the diagonal don't share
+ * any rows or columns, so each can be filled with a random arrangement of the digits; the
+ * solver then fills in the rest.
+ */
+void fillRandomSolution(char solution[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], SudokuRandom *random)
+{
+     char start[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT] = { 0 };
+     unsigned char digits[SUDOKU_DIGIT_MAX];
+     int block, i;
+
+     for (block = 0; block < SUDOKU_BLOCK_COUNT; block += SUDOKU_BLOCK_WIDTH + 1)
+     {
+          for (i = 0; i < SUDOKU_DIGIT_MAX; ++i)
+          {
+               digits[i] = i + 1;
+          }
+
+          shuffleSquares(digits, SUDOKU_DIGIT_MAX, random);
+
+          for (i = 0; i < SUDOKU_DIGIT_MAX; ++i)
+          {
+               start[(block / SUDOKU_BLOCK_WIDTH) * SUDOKU_BLOCK_HEIGHT + i / SUDOKU_BLOCK_WIDTH]
+                    [(block % SUDOKU_BLOCK_WIDTH) * SUDOKU_BLOCK_WIDTH + i % SUDOKU_BLOCK_WIDTH] = digits[i];
+          }
+     }
+
+     // any arrangement of the diagonal blocks can be completed, so this always succeeds
+     solveSudokuBoardContents(start, solution, NULL);
+}
+
+/**
+ * Puts an array of small values into random order (Fisher-Yates shuffle)
+ */
+void shuffleSquares(unsigned char *squares, int count, SudokuRandom *random)
+{
+     unsigned char swap;
+     int i, j;
+
+     for (i = count - 1; i > 0; --i)
+     {
+          j = nextSudokuRandom(random, i + 1);
+          swap = squares[i];
+          squares[i] = squares[j];
+          squares[j] = swap;
+     }
+}
+
+/**
+ * Checks whether a puzzle that just had a clue removed is still acceptable: no harder than the
+ * requested difficulty, and still with a unique solution.
+ * Inner function of 'generateSudokuBoard'
+ *
+ * @param puzzle Puzzle with the clue already removed
+ * @param square Position of the removed clue (row * 9 + column)
+ * @param value Digit the removed clue held
+ */
+bool isClueRemovable(const char puzzle[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], int square, int value,
+     const SudokuDifficulty *difficulty, SudokuBoard *scratchBoard)
+{
+     bool removable;
+
+     // a puzzle the assistant pipeline can solve is already known to be unique, so the solution
+     // only needs to be checked for the hardest difficulty
+     if (difficulty->grade <= SUDOKU_PIPELINE_STAGE_COUNT)
+     {
+          removable = gradeSudokuBoard(puzzle, scratchBoard) <= difficulty->grade;
+     }
+     // if the removed clue is the only place left for its digit in some row, column, or block, the
+     // solution is still unique. That's true of most removals, and much cheaper than counting
+     else
+     {
+          removable = isHiddenSingle(puzzle, square, value) || countSudokuSolutions(puzzle, 2, NULL) == 1;
+     }
+
+     return removable;
+}
+
+/**
+ * Checks whether a blank square is the only place left for a digit in its row, column, or block
+ * Inner function of 'isClueRemovable'
+ */
+bool isHiddenSingle(const char puzzle[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], int square, int value)
+{
+     DigitsPresent digitsPresent;
+     SudokuDigitTestField flag = SUDOKU_TEST_FLAG_SHIFT(value);
+     int row = sudokuSquareRow[square], column = sudokuSquareColumn[square], block = sudokuSquareBlock[square];
+     bool rowSingle = true, columnSingle = true, blockSingle = true, fits;
+     int other;
+
+     computeDigitsPresent(puzzle, &digitsPresent);
+
+     for (other = 0; other < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++other)
+     {
+          if (other != square && puzzle[0][other] == 0)
+          {
+               fits = !((digitsPresent.rows[sudokuSquareRow[other]] | digitsPresent.columns[sudokuSquareColumn[other]] |
+                    digitsPresent.blocks[sudokuSquareBlock[other]]) & flag);
+
+               rowSingle &= !(fits && sudokuSquareRow[other] == row);
+               columnSingle &= !(fits && sudokuSquareColumn[other] == column);
+               blockSingle &= !(fits && sudokuSquareBlock[other] == block);
+          }
+     }
+
+     return rowSingle || columnSingle || blockSingle;
+}
+
+/**
+ * Pool task: generate a single puzzle for a SudokuGenerateJob
+ */
+void generatePuzzleTask(void *shared, size_t taskIndex, SudokuBoard *workerBoard)
+{
+     SudokuGenerateJob *job = shared;
+     SudokuRandom random;
+
+     // seeded per puzzle rather than per thread, so the output doesn't depend on which thread
+     // happened to generate which puzzle
+     seedSudokuRandom(&random, job->seed + taskIndex);
+
+     job->isGenerated[taskIndex] = generateSudokuBoard(job->puzzles[taskIndex], job->difficulty, &random, workerBoard);
+}
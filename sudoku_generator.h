@@ -0,0 +1,51 @@
+#ifndef SUDOKU_GENERATOR_H
+#define SUDOKU_GENERATOR_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "sudoku_board.h"
+
+/** difficulty used when the generator isn't told which one to use */
+#define SUDOKU_GENERATOR_DEFAULT_DIFFICULTY "medium"
+
+#define SUDOKU_DIFFICULTY_NAME_LENGTH_MAX 16
+
+/**
+ * Small, fast pseudo-random number generator (xorshift64*). Each thread keeps its own, so
+ * generating puzzles on many threads needs no locking.
+ */
+struct SudokuRandom {
+     unsigned long long state;  /**< never 0 */
+};
+
+typedef struct SudokuRandom SudokuRandom;
+
+/**
+ * A level of difficulty, defined by how far down the assistant pipeline a player has to go to
+ * solve the puzzle (see gradeSudokuBoard)
+ */
+struct SudokuDifficulty {
+     char *name;
+     char *description;
+     int grade;
+};
+
+typedef struct SudokuDifficulty SudokuDifficulty;
+
+extern const SudokuDifficulty sudokuDifficulties[];
+
+const SudokuDifficulty *matchDifficulty(const char *name);
+
+void seedSudokuRandom(SudokuRandom *random, unsigned long long seed);
+
+unsigned nextSudokuRandom(SudokuRandom *random, unsigned bound);
+
+int gradeSudokuBoard(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], SudokuBoard *scratchBoard);
+
+bool generateSudokuBoard(char puzzle[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], const SudokuDifficulty *difficulty,
+     SudokuRandom *random, SudokuBoard *scratchBoard);
+
+int runGenerate(unsigned long count, const char *difficultyName, unsigned threadCount);
+
+#endif // !SUDOKU_GENERATOR_H
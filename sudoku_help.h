@@ -6,7 +6,15 @@
 "Default preset (when no argument is provided) is a blank sudoku board.\n" \
 "\nArguments:\n" \
 "   - <game-type>: Name of a preset board to start from:\n" \
-"         - \"blank\": A blank sudoku board\n"
+"         - \"blank\": A blank sudoku board\n" \
+"         - \"random <difficulty>\": A newly-generated puzzle with exactly one solution. " \
+"Difficulty is one of:\n" \
+"              - \"easy\": Solvable by the 'crosshatch' assistant alone\n" \
+"              - \"medium\" (default): Also needs the 'locked' assistant\n" \
+"              - \"hard\": Also needs the 'subsets' assistant\n" \
+"              - \"expert\": Also needs the 'fish' assistant\n" \
+"              - \"fiendish\": Also needs the 'chains' assistant\n" \
+"              - \"extreme\": Beyond every assistant; needs trial and error\n"
 
 #define SUDOKU_HELP_LOAD \
 "\nDigits may be separated by commas, spaces, any delimiting character, or nothing at all. " \
@@ -16,12 +24,30 @@
 "squares will be blank. If there are too many digits in the file, additional digits will " \
 "be ignored once the board is full. Nonsense characters that don't correspond to digits " \
 "will be automatically ignored.\n" \
+"\nA text file may hold several boards one after another; each run of 81 digits is one board. " \
+"A puzzle bank (a compact binary file created with 'save' or 'sudoku --convert') is " \
+"recognized automatically.\n" \
 "\nArguments:\n" \
-"   - <filename>: Name of the text file to load\n"
+"   - <filename>: Name of the text file or puzzle bank to load\n" \
+"   - [puzzle-number]: Which board in the file to load, counting from 1 (default 1)\n"
+
+#define SUDOKU_HELP_SAVE \
+"\nAdds the current state of the board to the end of a puzzle bank: a compact binary file " \
+"that stores each board in 41 bytes. The file is created if it doesn't exist. " \
+"Use 'load <filename> <puzzle-number>' to load a board back from it.\n" \
+"\nArguments:\n" \
+"   - <filename>: Name of the puzzle bank to add the board to\n"
 
 #define SUDOKU_HELP_CHECK \
 "\nDisplays feedback if any problems are encountered.\n"
 
+#define SUDOKU_HELP_COUNT \
+"\nCounts how many complete solutions the board has, stopping once the limit is reached. " \
+"The search is shared among all the processors of the computer.\n" \
+"\nArguments:\n" \
+"   - [limit]: Stop counting after this many solutions (default 2, which is enough to tell " \
+"whether the board has no solution, exactly one, or more than one)\n"
+
 #define SUDOKU_HELP_CHANGE \
 "\nUsing a value of '0' means the square will be blank.\n" \
 "\nArguments:\n" \
@@ -35,32 +61,100 @@
 "\nArguments:\n" \
 "   - <assistant-type>: Name of the assistant to use:\n" \
 "         - \"crosshatch\": Uses cross-hatch scanning to identify 'hidden singles'\n" \
-"         - \"locked\": Uses row/column and block exclusion to 'lock' candidates\n"
+"         - \"locked\": Uses row/column and block exclusion to 'lock' candidates\n" \
+"         - \"subsets\": Uses naked and hidden pairs, triples and quads to rule out candidates\n" \
+"         - \"fish\": Uses X-Wings, Swordfish and Jellyfish to rule out candidates\n" \
+"         - \"chains\": Follows chains of strong and weak links between candidates\n" \
+"         - \"exhaustive\": Searches every possibility to find the complete solution\n" \
+"         - \"dlx\": Solves the board as an exact-cover problem using Dancing Links\n"
 
 #define SUDOKU_HELP_SOLVE \
 "\nAutomatically applies the suggestions of an assistant until no more suggestions are available. " \
-"This will either solve the sudoku puzzle or exhaust the help of the given assistant.\n" \
+"This will either solve the sudoku puzzle or exhaust the help of the given assistant. " \
+"A single 'undo' rolls back everything the command changed.\n" \
+"\nWith 'all', the logical assistants (every one but \"exhaustive\" and \"dlx\") are run " \
+"cheapest first, going back to the cheapest after any progress, the way a person would solve. " \
+"Afterwards, a table shows how often each was called and succeeded, how many squares it " \
+"filled and how long it took, followed by the hardest technique the puzzle needed.\n" \
 "\nArguments:\n" \
-"   - <assistant-type>: Name of the assistant to use:\n" \
+"   - <assistant-type|all>: Name of the assistant to use, or 'all':\n" \
 "         - \"crosshatch\": Uses cross-hatch scanning to identify 'hidden singles'\n" \
-"         - \"locked\": Uses row/column and block exclusion to 'lock' candidates\n"
+"         - \"locked\": Uses row/column and block exclusion to 'lock' candidates\n" \
+"         - \"subsets\": Uses naked and hidden pairs, triples and quads to rule out candidates\n" \
+"         - \"fish\": Uses X-Wings, Swordfish and Jellyfish to rule out candidates\n" \
+"         - \"chains\": Follows chains of strong and weak links between candidates\n" \
+"         - \"exhaustive\": Searches every possibility to find the complete solution\n" \
+"         - \"dlx\": Solves the board as an exact-cover problem using Dancing Links\n"
 
 #define SUDOKU_HELP_DISPLAY \
-""
+"\nThe board is shown as a labelled grid, or as a single line of 81 digits ('0' for a blank " \
+"square) that other programs, and the 'load' command, can read back. The format chosen is " \
+"used for every board shown afterwards; starting with '--compact' chooses the single line. " \
+"The 'candidates' format is the grid with pencil marks (see the 'candidates' command).\n" \
+"\nArguments:\n" \
+"   - [grid|compact|candidates]: Format to show the board in (default: whichever was used last)\n"
+
+#define SUDOKU_HELP_CANDIDATES \
+"\nEvery blank square is drawn as a 3x3 mini-grid of its pencil marks: the digits that could " \
+"still go in it, laid out like a phone keypad (1 top-left, 5 in the middle, 9 bottom-right). " \
+"Filled squares show their digit in brackets. Pencil marks start as every digit not already " \
+"in the square's row, column or block, and follow the board as digits are placed and removed.\n"
+
+#define SUDOKU_HELP_MARK \
+"\nPencils digits back into a square's marks after 'unmark' crossed them out. A digit " \
+"already in the square's row, column or block can't be marked.\n" \
+"\nArguments:\n" \
+"   - <column-letter>: Letter identifying the column of the square\n" \
+"   - <row-number>: Number identifying the row of the square\n" \
+"   - <digit> [digit...]: Digits to mark, with or without spaces between them\n"
+
+#define SUDOKU_HELP_UNMARK \
+"\nCrosses digits out of a square's pencil marks, for candidates you have ruled out yourself. " \
+"They stay crossed out until marked again or a new board is started.\n" \
+"\nArguments:\n" \
+"   - <column-letter>: Letter identifying the column of the square\n" \
+"   - <row-number>: Number identifying the row of the square\n" \
+"   - <digit> [digit...]: Digits to cross out, with or without spaces between them\n"
 
 #define SUDOKU_HELP_UNDO \
 "\nEvery time you use the 'change' command to alter a square, an undo step is created. \n" \
 "Calling the command with no arguments rolls back a single undo step, as long as there " \
-"are steps to undo.\n" \
+"are steps to undo. All the changes made by one 'solve' command count as a single step.\n" \
 "\nArguments:\n" \
 "   - <number-of-steps>: Number of undo steps to roll back\n"
 
 #define SUDOKU_HELP_REDO \
 "\nIf you used the 'undo' command to roll back changes, the 'redo' command makes the changes " \
-"again.\n" \
+"again. If a square was changed since then, the undone changes are on another branch (see 'branches').\n" \
 "\nArguments:\n" \
 "   - <number-of-steps>: Number of steps to redo\n"
 
+#define SUDOKU_HELP_GOTO \
+"\nPuts the board back the way it was after the given number of changes, counting from the start " \
+"of the game. Unlike 'undo' and 'redo', it doesn't matter how far away the step is: the board is " \
+"restored from the nearest checkpoint (see 'history'). Steps on either side are kept, so you can " \
+"still 'undo', 'redo' or 'goto' afterwards.\n" \
+"\nArguments:\n" \
+"   - <step>: Number of changes to keep, from 0 (the starting board) to the number of steps in history\n"
+
+#define SUDOKU_HELP_BRANCHES \
+"\nChanging a square after using 'undo' doesn't throw away the steps that were undone: they " \
+"stay in the board's history as a separate branch. This command lists every branch, marking " \
+"the one the board is on with '*', and how many steps each shares with it.\n"
+
+#define SUDOKU_HELP_BRANCH \
+"\nMakes another branch of the board's history the current one, and moves the board to the " \
+"end of it. The branch that was current stays in history, so you can switch back to it.\n" \
+"\nArguments:\n" \
+"   - <branch-number>: Number of the branch, as listed by 'branches'\n"
+
+#define SUDOKU_HELP_HISTORY \
+"\nShows how many steps are in the board's history and which one the board is at. The board is " \
+"also copied every so many steps, so 'goto' never has to replay more than that many changes.\n" \
+"\nArguments:\n" \
+"   - [checkpoint-interval]: Number of steps between copies of the board; smaller is faster but " \
+"uses more memory\n"
+
 #define SUDOKU_HELP_HELP \
 "\nThis is the command you're using right now.\n" \
 "\nArguments:\n" \
@@ -0,0 +1,123 @@
+/******************************************************************************
+ * Program: sudoku_lookup.c
+ *
+ * Purpose: Hash tables for finding commands and assistants by name, or by
+ *          any unique abbreviation of their name
+ *
+ *****************************************************************************/
+#include <string.h>
+
+#include "sudoku_lookup.h"
+#include "sudoku_utility.h"
+
+
+unsigned hashSudokuName(const char *name, size_t length);
+void addSudokuNameKey(SudokuNameTable *table, const char *name, size_t length, int entry, bool isWholeName);
+
+
+/**
+ * FNV-1a hash of the first 'length' characters of a name
+ */
+unsigned hashSudokuName(const char *name, size_t length)
+{
+     unsigned hash = 2166136261u;
+     size_t i;
+
+     for (i = 0; i < length; ++i)
+     {
+          hash = (hash ^ (unsigned char) name[i]) * 16777619u;
+     }
+
+     return hash;
+}
+
+/**
+ * Fills a name table from a list of entries. Every entry is a struct whose first member is its
+ * name (like SudokuCommand and SudokuAssistant), so the list is walked with a stride.
+ *
+ * @param table Table to fill
+ * @param entries First entry of the list
+ * @param count Number of entries in the list
+ * @param stride Size of each entry, in bytes
+ */
+void buildSudokuNameTable(SudokuNameTable *table, const void *entries, size_t count, size_t stride)
+{
+     size_t i, length;
+
+     memset(table, 0, sizeof(*table));
+
+     for (i = 0; i < count; ++i)
+     {
+          const char *name = *(const char* const*) ((const char*) entries + i * stride);
+
+          for (length = 1; length <= strlen(name); ++length)
+          {
+               addSudokuNameKey(table, name, length, (int) i, length == strlen(name));
+          }
+     }
+}
+
+/**
+ * Adds one key to a name table. A key that's already there belongs to whichever entry has it as
+ * its whole name; otherwise, if it came from two different entries, it's ambiguous.
+ */
+void addSudokuNameKey(SudokuNameTable *table, const char *name, size_t length, int entry, bool isWholeName)
+{
+     unsigned slot = hashSudokuName(name, length) & (SUDOKU_NAME_TABLE_SIZE - 1);
+     size_t probes = 0;
+
+     // linear probing, until the key or an empty slot turns up
+     while (table->slots[slot].name &&
+            !(table->slots[slot].length == length && memcmp(table->slots[slot].name, name, length) == 0))
+     {
+          slot = (slot + 1) & (SUDOKU_NAME_TABLE_SIZE - 1);
+
+          if (++probes > SUDOKU_NAME_TABLE_SIZE / 2)
+          {
+               terminate("ERROR: too many names for SUDOKU_NAME_TABLE_SIZE");
+          }
+     }
+
+     if (table->slots[slot].name == NULL)
+     {
+          table->slots[slot].name = name;
+          table->slots[slot].length = (unsigned char) length;
+          table->slots[slot].isWholeName = isWholeName;
+          table->slots[slot].entry = (short) entry;
+     }
+     else if (isWholeName)
+     {
+          table->slots[slot].isWholeName = true;
+          table->slots[slot].entry = (short) entry;
+     }
+     else if (!table->slots[slot].isWholeName && table->slots[slot].entry != entry)
+     {
+          table->slots[slot].entry = SUDOKU_NAME_AMBIGUOUS;
+     }
+}
+
+/**
+ * Finds an entry by its whole name, or by a prefix that no other entry's name starts with
+ *
+ * @param table Table built by buildSudokuNameTable
+ * @param name Name to look for
+ * @return Index of the entry, SUDOKU_NAME_NOT_FOUND, or SUDOKU_NAME_AMBIGUOUS
+ */
+int lookupSudokuName(const SudokuNameTable *table, const char *name)
+{
+     size_t length = strlen(name);
+     unsigned slot = hashSudokuName(name, length) & (SUDOKU_NAME_TABLE_SIZE - 1);
+     int entry = SUDOKU_NAME_NOT_FOUND;
+
+     while (entry == SUDOKU_NAME_NOT_FOUND && table->slots[slot].name)
+     {
+          if (table->slots[slot].length == length && memcmp(table->slots[slot].name, name, length) == 0)
+          {
+               entry = table->slots[slot].entry;
+          }
+
+          slot = (slot + 1) & (SUDOKU_NAME_TABLE_SIZE - 1);
+     }
+
+     return entry;
+}
@@ -0,0 +1,62 @@
+#ifndef SUDOKU_LOOKUP_H
+#define SUDOKU_LOOKUP_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/** number of slots in a name table. Must be a power of 2, and at least twice the number of keys */
+#define SUDOKU_NAME_TABLE_SIZE 512
+
+/** returned by lookupSudokuName if nothing has the name, or more than one thing starts with it */
+#define SUDOKU_NAME_NOT_FOUND -1
+#define SUDOKU_NAME_AMBIGUOUS -2
+
+// run-once wrappers, so a table can be built on first use even if that's on several threads at once
+#ifdef _WIN32
+typedef INIT_ONCE SudokuOnce;
+#define SUDOKU_ONCE_INIT INIT_ONCE_STATIC_INIT
+#define SUDOKU_ONCE_FUNCTION(name) BOOL CALLBACK name(PINIT_ONCE once, PVOID parameter, PVOID *context)
+#define SUDOKU_ONCE_RETURN return TRUE
+#define runSudokuOnce(once, function) InitOnceExecuteOnce(once, function, NULL, NULL)
+#else
+typedef pthread_once_t SudokuOnce;
+#define SUDOKU_ONCE_INIT PTHREAD_ONCE_INIT
+#define SUDOKU_ONCE_FUNCTION(name) void name(void)
+#define SUDOKU_ONCE_RETURN return
+#define runSudokuOnce(once, function) pthread_once(once, function)
+#endif
+
+/**
+ * One key of a name table: a whole name, or a prefix of one
+ */
+struct SudokuNameSlot {
+     const char *name;       /**< name the key is taken from, or NULL if the slot is empty */
+     unsigned char length;   /**< number of characters of 'name' in the key */
+     bool isWholeName;       /**< the key is all of 'name', so it beats any name it's a prefix of */
+     short entry;            /**< index of the named entry, or SUDOKU_NAME_AMBIGUOUS */
+};
+
+typedef struct SudokuNameSlot SudokuNameSlot;
+
+/**
+ * Open-addressed hash table from every name in a list, and every prefix of one, to the name's
+ * position in the list. Finding a name costs one hash and usually one comparison, however many
+ * names there are; a prefix shared by several names maps to SUDOKU_NAME_AMBIGUOUS.
+ */
+struct SudokuNameTable {
+     SudokuNameSlot slots[SUDOKU_NAME_TABLE_SIZE];
+};
+
+typedef struct SudokuNameTable SudokuNameTable;
+
+void buildSudokuNameTable(SudokuNameTable *table, const void *entries, size_t count, size_t stride);
+
+int lookupSudokuName(const SudokuNameTable *table, const char *name);
+
+#endif // !SUDOKU_LOOKUP_H
@@ -0,0 +1,468 @@
+/******************************************************************************
+ * Program: sudoku_parallel.c
+ *
+ * Purpose: Work-stealing thread pool, and a headless mode that uses it to
+ *          solve a whole file of puzzles on every core
+ *
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "sudoku_assistant.h"
+#include "sudoku_batch.h"
+#include "sudoku_board.h"
+#include "sudoku_parallel.h"
+#include "sudoku_reader.h"
+#include "sudoku_solver.h"
+#include "sudoku_utility.h"
+
+// minimal portable wrappers, so the pool logic below reads the same on every platform
+#ifdef _WIN32
+typedef HANDLE SudokuThread;
+typedef CRITICAL_SECTION SudokuMutex;
+#define SUDOKU_THREAD_FUNCTION(name) DWORD WINAPI name(LPVOID argument)
+#define SUDOKU_THREAD_RETURN return 0
+#define initializeSudokuMutex(mutex) InitializeCriticalSection(mutex)
+#define destroySudokuMutex(mutex) DeleteCriticalSection(mutex)
+#define lockSudokuMutex(mutex) EnterCriticalSection(mutex)
+#define unlockSudokuMutex(mutex) LeaveCriticalSection(mutex)
+#define startSudokuThread(thread, function, argument) \
+     ((*(thread) = CreateThread(NULL, 0, function, argument, 0, NULL)) != NULL)
+#define joinSudokuThread(thread) (WaitForSingleObject(thread, INFINITE), CloseHandle(thread))
+#else
+typedef pthread_t SudokuThread;
+typedef pthread_mutex_t SudokuMutex;
+#define SUDOKU_THREAD_FUNCTION(name) void *name(void *argument)
+#define SUDOKU_THREAD_RETURN return NULL
+#define initializeSudokuMutex(mutex) pthread_mutex_init(mutex, NULL)
+#define destroySudokuMutex(mutex) pthread_mutex_destroy(mutex)
+#define lockSudokuMutex(mutex) pthread_mutex_lock(mutex)
+#define unlockSudokuMutex(mutex) pthread_mutex_unlock(mutex)
+#define startSudokuThread(thread, function, argument) \
+     (pthread_create(thread, NULL, function, argument) == 0)
+#define joinSudokuThread(thread) pthread_join(thread, NULL)
+#endif
+
+/**
+ * One worker's queue of task indices. Because tasks are handed out as contiguous ranges, the
+ * queue is simply the range [head, tail): the owner takes tasks from the head, and an idle worker
+ * steals the back half from the tail.
+ */
+struct SudokuTaskDeque {
+     SudokuMutex lock;
+     size_t head;   /**< next task the owner will run */
+     size_t tail;   /**< off-the-end index of the owner's range */
+};
+
+typedef struct SudokuTaskDeque SudokuTaskDeque;
+
+struct SudokuTaskPool {
+     SudokuTaskDeque *deques;  /**< one per worker */
+     unsigned workerCount;
+     SudokuPoolTask task;
+     void *shared;
+};
+
+typedef struct SudokuTaskPool SudokuTaskPool;
+
+struct SudokuWorker {
+     SudokuTaskPool *pool;
+     unsigned id;              /**< index of this worker's own deque */
+};
+
+typedef struct SudokuWorker SudokuWorker;
+
+/**
+ * Puzzles read from the input file, and the boards each one ended up as
+ */
+struct SudokuParallelSolveJob {
+     char (*puzzles)[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     char (*results)[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     bool *isValid;            /**< false for lines that weren't a well-formed puzzle */
+     const SudokuAssistant *assistant;
+};
+
+typedef struct SudokuParallelSolveJob SudokuParallelSolveJob;
+
+/** how many pieces to split a solution count into, per thread, so idle threads have work to steal */
+#define SUDOKU_COUNT_PIECES_PER_THREAD 16
+
+/**
+ * Pieces of a solution count (see splitSudokuSearch), and the running total across all of them
+ */
+struct SudokuParallelCountJob {
+     char (*subproblems)[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     unsigned long limit;
+     unsigned long total;         /**< solutions counted so far; guarded by 'lock' */
+     SudokuMutex lock;
+};
+
+typedef struct SudokuParallelCountJob SudokuParallelCountJob;
+
+
+bool takeSudokuTask(SudokuTaskPool *pool, unsigned workerId, size_t *taskIndex);
+SUDOKU_THREAD_FUNCTION(runSudokuWorker);
+void solvePuzzleTask(void *shared, size_t taskIndex, SudokuBoard *workerBoard);
+void countSubproblemTask(void *shared, size_t taskIndex, SudokuBoard *workerBoard);
+
+
+/**
+ * Number of processors available to the program (at least 1)
+ */
+unsigned getSudokuProcessorCount()
+{
+     long count;
+
+#ifdef _WIN32
+     SYSTEM_INFO systemInfo;
+     GetSystemInfo(&systemInfo);
+     count = systemInfo.dwNumberOfProcessors;
+#else
+     count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+     return count > 0 ? (unsigned) count : 1;
+}
+
+/**
+ * Runs 'task' once for each index in [0, taskCount), spread across a pool of worker threads.
+ * Returns once every task has finished.
+ *
+ * Each worker starts with an equal share of the indices. A worker that runs out of its own tasks
+ * steals half of the remaining tasks from another worker, so uneven task costs (e.g. a few very
+ * hard puzzles) don't leave threads idle.
+ *
+ * @param taskCount Number of tasks to run
+ * @param threadCount Number of worker threads (0 means one per processor)
+ * @param task Function to run for each task index
+ * @param shared Pointer passed to every call of 'task'
+ */
+void runSudokuTaskPool(size_t taskCount, unsigned threadCount, SudokuPoolTask task, void *shared)
+{
+     SudokuTaskPool pool;
+     SudokuWorker *workers;
+     SudokuThread *threads;
+     unsigned i;
+
+     if (threadCount == 0)
+     {
+          threadCount = getSudokuProcessorCount();
+     }
+
+     // no point in having workers that start without any tasks
+     if (threadCount > taskCount)
+     {
+          threadCount = taskCount > 0 ? (unsigned) taskCount : 1;
+     }
+
+     pool.workerCount = threadCount;
+     pool.task = task;
+     pool.shared = shared;
+     pool.deques = malloc(sizeof(SudokuTaskDeque) * threadCount);
+     workers = malloc(sizeof(SudokuWorker) * threadCount);
+     threads = malloc(sizeof(SudokuThread) * threadCount);
+
+     if (pool.deques == NULL || workers == NULL || threads == NULL)
+     {
+          terminate("ERROR: could not create task pool");
+     }
+
+     // divide tasks into contiguous, nearly-equal ranges
+     for (i = 0; i < threadCount; ++i)
+     {
+          initializeSudokuMutex(&pool.deques[i].lock);
+          pool.deques[i].head = taskCount * i / threadCount;
+          pool.deques[i].tail = taskCount * (i + 1) / threadCount;
+
+          workers[i].pool = &pool;
+          workers[i].id = i;
+     }
+
+     // worker 0 runs on the calling thread, so a pool of 1 starts no threads at all
+     for (i = 1; i < threadCount; ++i)
+     {
+          if (!startSudokuThread(&threads[i], runSudokuWorker, &workers[i]))
+          {
+               terminate("ERROR: could not start worker thread");
+          }
+     }
+
+     runSudokuWorker(&workers[0]);
+
+     for (i = 1; i < threadCount; ++i)
+     {
+          joinSudokuThread(threads[i]);
+     }
+
+     for (i = 0; i < threadCount; ++i)
+     {
+          destroySudokuMutex(&pool.deques[i].lock);
+     }
+
+     free(threads);
+     free(workers);
+     free(pool.deques);
+}
+
+/**
+ * Gets the next task for a worker: from its own deque if possible, otherwise by stealing.
+ *
+ * @return False if every deque is empty. No tasks are ever added once the pool starts, so at
+ *         that point the worker is finished.
+ */
+bool takeSudokuTask(SudokuTaskPool *pool, unsigned workerId, size_t *taskIndex)
+{
+     SudokuTaskDeque *own = &pool->deques[workerId];
+     bool found = false;
+     unsigned i;
+
+     lockSudokuMutex(&own->lock);
+     if (own->head < own->tail)
+     {
+          *taskIndex = own->head++;
+          found = true;
+     }
+     unlockSudokuMutex(&own->lock);
+
+     // visit the other workers in turn, starting with the next one, so thieves spread out
+     for (i = 1; !found && i < pool->workerCount; ++i)
+     {
+          SudokuTaskDeque *victim = &pool->deques[(workerId + i) % pool->workerCount];
+          size_t stolenHead = 0, stolenTail = 0;
+
+          lockSudokuMutex(&victim->lock);
+          if (victim->head < victim->tail)
+          {
+               // take the back half (rounded up, so a single remaining task can be stolen)
+               stolenTail = victim->tail;
+               stolenHead = victim->tail - (victim->tail - victim->head + 1) / 2;
+               victim->tail = stolenHead;
+          }
+          unlockSudokuMutex(&victim->lock);
+
+          if (stolenHead < stolenTail)
+          {
+               // run the first stolen task now; the rest become this worker's own deque
+               *taskIndex = stolenHead;
+               found = true;
+
+               lockSudokuMutex(&own->lock);
+               own->head = stolenHead + 1;
+               own->tail = stolenTail;
+               unlockSudokuMutex(&own->lock);
+          }
+     }
+
+     return found;
+}
+
+/**
+ * Thread body for a pool worker: runs tasks until there are none left anywhere
+ */
+SUDOKU_THREAD_FUNCTION(runSudokuWorker)
+{
+     SudokuWorker *worker = argument;
+     struct SudokuBoard board = { 0 };
+     size_t taskIndex;
+
+     // each worker owns a board and History for its whole lifetime
+     initializeSudokuBoard(&board);
+
+     while (takeSudokuTask(worker->pool, worker->id, &taskIndex))
+     {
+          worker->pool->task(worker->pool->shared, taskIndex, &board);
+     }
+
+     freeSudokuBoardResources(&board);
+
+     SUDOKU_THREAD_RETURN;
+}
+
+/**
+ * Pool task: solve a single puzzle from a SudokuParallelSolveJob
+ */
+void solvePuzzleTask(void *shared, size_t taskIndex, SudokuBoard *workerBoard)
+{
+     SudokuParallelSolveJob *job = shared;
+
+     // reset board and history in place, then load the puzzle
+     initializeSudokuBoard(workerBoard);
+
+     if (job->isValid[taskIndex])
+     {
+          memcpy(workerBoard->contents, job->puzzles[taskIndex], sizeof(workerBoard->contents));
+          refreshSudokuBoardDigits(workerBoard);
+
+          solveWithAssistant(workerBoard, job->assistant);
+     }
+
+     memcpy(job->results[taskIndex], workerBoard->contents, sizeof(workerBoard->contents));
+}
+
+/**
+ * Solves every puzzle in a batch file on a pool of worker threads. Input and output use the
+ * same format as batch mode (see sudoku_batch.c), and solutions are written in input order.
+ *
+ * @param fileName Name of the batch file to read
+ * @param assistantName Name of the assistant that will solve each puzzle
+ * @param threadCount Number of worker threads (0 means one per processor)
+ * @return Exit status for the program
+ */
+int runParallelSolve(const char *fileName, const char *assistantName, unsigned threadCount)
+{
+     int status = EXIT_SUCCESS;
+     SudokuParallelSolveJob job = { 0 };
+     SudokuPuzzleFile file;
+
+     job.assistant = matchAssistant((char*) assistantName);
+
+     if (job.assistant == NULL)
+     {
+          fprintf(stderr, "Sorry, \"%s\" is not a valid assistant.\n", assistantName);
+          status = EXIT_FAILURE;
+     }
+     else if (!openSudokuPuzzleFile(&file, fileName))
+     {
+          fprintf(stderr, "Sorry, file \"%s\" not found\n", fileName);
+          status = EXIT_FAILURE;
+     }
+     else
+     {
+          const char *line;
+          size_t lineLength, puzzleCount = 0, capacity = 1, solvedCount = 0, i;
+          unsigned long lineNumber = 0;
+
+          // a well-formed file has one 82-byte line per puzzle, which makes a good first guess
+          capacity = file.length / (SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT + 1) + 1;
+          job.puzzles = malloc(sizeof(*job.puzzles) * capacity);
+          job.isValid = malloc(sizeof(*job.isValid) * capacity);
+
+          // read every puzzle up front, so the workers never touch the file
+          while (job.puzzles && job.isValid && readSudokuFileLine(&file, &line, &lineLength))
+          {
+               ++lineNumber;
+
+               // skip blank lines and comments
+               if (lineLength > 0 && line[0] != '#')
+               {
+                    if (puzzleCount == capacity)
+                    {
+                         capacity *= 2;
+                         job.puzzles = realloc(job.puzzles, sizeof(*job.puzzles) * capacity);
+                         job.isValid = realloc(job.isValid, sizeof(*job.isValid) * capacity);
+                    }
+
+                    if (job.puzzles && job.isValid)
+                    {
+                         job.isValid[puzzleCount] = parseSudokuBoardLine(line, lineLength, job.puzzles[puzzleCount]);
+
+                         if (!job.isValid[puzzleCount])
+                         {
+                              fprintf(stderr, "Line %lu: expected 81 squares (digits, or '.' for blank)\n", lineNumber);
+                         }
+
+                         ++puzzleCount;
+                    }
+               }
+          }
+
+          closeSudokuPuzzleFile(&file);
+
+          job.results = malloc(sizeof(*job.results) * capacity);
+
+          if (!job.puzzles || !job.isValid || !job.results)
+          {
+               terminate("ERROR: not enough memory to hold puzzle file");
+          }
+
+          runSudokuTaskPool(puzzleCount, threadCount, solvePuzzleTask, &job);
+
+          // results are checked all together once the workers are done
+          solvedCount = validateSudokuSolutions((const char (*)[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]) job.results, puzzleCount, NULL);
+
+          for (i = 0; i < puzzleCount; ++i)
+          {
+               writeSudokuBoardLine(job.results[i], stdout);
+          }
+
+          fprintf(stderr, "Solved %lu of %lu puzzles\n", (unsigned long) solvedCount, (unsigned long) puzzleCount);
+
+          free(job.puzzles);
+          free(job.isValid);
+          free(job.results);
+     }
+
+     return status;
+}
+
+/**
+ * Counts the solutions of a sudoku board on a pool of worker threads, stopping once 'limit' have
+ * been found. The search tree is split at its first few branch points, and each piece is counted
+ * separately; pieces still waiting when the limit is reached are skipped.
+ *
+ * @param contents Board contents to examine (0 for blank squares)
+ * @param limit Stop counting after this many solutions
+ * @param threadCount Number of worker threads (0 means one per processor)
+ * @return Number of solutions found, at most 'limit'
+ */
+unsigned long countSudokuSolutionsParallel(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT],
+     unsigned long limit, unsigned threadCount)
+{
+     SudokuParallelCountJob job = { 0 };
+     size_t pieceCount;
+
+     if (threadCount == 0)
+     {
+          threadCount = getSudokuProcessorCount();
+     }
+
+     job.limit = limit;
+     pieceCount = splitSudokuSearch(contents, (size_t) threadCount * SUDOKU_COUNT_PIECES_PER_THREAD,
+          &job.subproblems, &job.total);
+
+     if (job.total < limit && pieceCount > 0)
+     {
+          initializeSudokuMutex(&job.lock);
+          runSudokuTaskPool(pieceCount, threadCount, countSubproblemTask, &job);
+          destroySudokuMutex(&job.lock);
+     }
+
+     free(job.subproblems);
+
+     return job.total < limit ? job.total : limit;
+}
+
+/**
+ * Pool task: count the solutions of one piece of a SudokuParallelCountJob
+ */
+void countSubproblemTask(void *shared, size_t taskIndex, SudokuBoard *workerBoard)
+{
+     SudokuParallelCountJob *job = shared;
+     unsigned long remaining, count;
+
+     // counting works on the piece's own copy of the board, so the worker's board isn't needed
+     (void) workerBoard;
+
+     lockSudokuMutex(&job->lock);
+     remaining = job->total < job->limit ? job->limit - job->total : 0;
+     unlockSudokuMutex(&job->lock);
+
+     // no point counting past the limit: only the solutions still needed are looked for
+     if (remaining > 0)
+     {
+          count = countSudokuSolutions(job->subproblems[taskIndex], remaining, NULL);
+
+          lockSudokuMutex(&job->lock);
+          job->total += count;
+          unlockSudokuMutex(&job->lock);
+     }
+}
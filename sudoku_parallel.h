@@ -0,0 +1,29 @@
+#ifndef SUDOKU_PARALLEL_H
+#define SUDOKU_PARALLEL_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "sudoku_board.h"
+
+/**
+ * A unit of work for the task pool. Called once for every task index, on whichever worker thread
+ * picks it up. Each worker thread owns a SudokuBoard (with its own History) that it passes to
+ * every task it runs, so tasks never share a board.
+ *
+ * @param shared Pointer given to runSudokuTaskPool, shared by all tasks
+ * @param taskIndex Which task to run, in the range [0, taskCount)
+ * @param workerBoard Board owned by the calling worker thread
+ */
+typedef void (*SudokuPoolTask)(void *shared, size_t taskIndex, SudokuBoard *workerBoard);
+
+unsigned getSudokuProcessorCount();
+
+void runSudokuTaskPool(size_t taskCount, unsigned threadCount, SudokuPoolTask task, void *shared);
+
+int runParallelSolve(const char *fileName, const char *assistantName, unsigned threadCount);
+
+unsigned long countSudokuSolutionsParallel(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT],
+     unsigned long limit, unsigned threadCount);
+
+#endif // !SUDOKU_PARALLEL_H
@@ -0,0 +1,520 @@
+/******************************************************************************
+ * Program: sudoku_reader.c
+ *
+ * Purpose: Memory-mapped puzzle file reader, with vectorized scanning of the
+ *          digits that make up each board
+ *
+ *****************************************************************************/
+// mmap and madvise are POSIX and BSD extensions, hidden from strict ISO C builds (-std=c11)
+// unless asked for before the first system header
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#endif
+
+#include <memory.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SUDOKU_READER_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "sudoku_reader.h"
+#include "sudoku_utility.h"
+
+
+unsigned lowestSetBitIndex(unsigned mask);
+bool readSudokuPuzzleStream(SudokuPuzzleFile *file);
+
+
+/**
+ * Opens a puzzle file and maps its contents into memory. Pipes and devices (e.g. /dev/stdin)
+ * can't be mapped and report no size, so they're read into a buffer instead.
+ *
+ * @param file SudokuPuzzleFile to initialize
+ * @param fileName Name of the file to open
+ * @return False if the file couldn't be opened or mapped
+ */
+bool openSudokuPuzzleFile(SudokuPuzzleFile *file, const char *fileName)
+{
+     bool status = true;
+
+     memset(file, 0, sizeof(*file));
+
+#ifdef _WIN32
+     LARGE_INTEGER fileSize;
+
+     file->fileHandle = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL,
+          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+     if (file->fileHandle == INVALID_HANDLE_VALUE)
+     {
+          status = false;
+     }
+     else if (GetFileType(file->fileHandle) != FILE_TYPE_DISK)
+     {
+          status = readSudokuPuzzleStream(file);
+     }
+     else if (!GetFileSizeEx(file->fileHandle, &fileSize))
+     {
+          status = false;
+     }
+     // an empty file can't be mapped, but it's still a valid (empty) puzzle file
+     else if (fileSize.QuadPart > 0)
+     {
+          file->length = (size_t) fileSize.QuadPart;
+          file->mappingHandle = CreateFileMappingA(file->fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+          if (file->mappingHandle == NULL ||
+              (file->data = MapViewOfFile(file->mappingHandle, FILE_MAP_READ, 0, 0, 0)) == NULL)
+          {
+               status = false;
+          }
+     }
+#else
+     struct stat fileStatus;
+
+     file->descriptor = open(fileName, O_RDONLY);
+
+     if (file->descriptor < 0 || fstat(file->descriptor, &fileStatus) != 0)
+     {
+          status = false;
+     }
+     else if (!S_ISREG(fileStatus.st_mode))
+     {
+          status = readSudokuPuzzleStream(file);
+     }
+     // an empty file can't be mapped, but it's still a valid (empty) puzzle file
+     else if (fileStatus.st_size > 0)
+     {
+          void *mapping = mmap(NULL, (size_t) fileStatus.st_size, PROT_READ, MAP_PRIVATE, file->descriptor, 0);
+
+          if (mapping == MAP_FAILED)
+          {
+               status = false;
+          }
+          else
+          {
+               file->data = mapping;
+               file->length = (size_t) fileStatus.st_size;
+
+               // puzzles are read front to back, so let the OS read ahead aggressively
+#ifdef MADV_SEQUENTIAL
+               madvise(mapping, file->length, MADV_SEQUENTIAL);
+#endif
+          }
+     }
+#endif
+
+     if (!status)
+     {
+          closeSudokuPuzzleFile(file);
+     }
+
+     return status;
+}
+
+/**
+ * Reads the whole of a pipe or device into a buffer, for the files openSudokuPuzzleFile can't map
+ *
+ * @param file SudokuPuzzleFile whose handle or descriptor is open
+ * @return False if reading failed
+ */
+bool readSudokuPuzzleStream(SudokuPuzzleFile *file)
+{
+     size_t capacity = 0;
+     bool status = true, done = false;
+
+     while (status && !done)
+     {
+          if (file->length == capacity)
+          {
+               capacity = capacity ? capacity * 2 : 65536;
+               file->buffer = realloc(file->buffer, capacity);
+
+               if (file->buffer == NULL)
+               {
+                    terminate("ERROR: unable to allocate puzzle file buffer");
+               }
+          }
+
+#ifdef _WIN32
+          DWORD count;
+
+          if (!ReadFile(file->fileHandle, file->buffer + file->length, (DWORD) (capacity - file->length), &count, NULL))
+          {
+               // the writing end of a pipe closing is how a pipe reports end of file
+               status = GetLastError() == ERROR_BROKEN_PIPE;
+               done = true;
+          }
+#else
+          ssize_t count = read(file->descriptor, file->buffer + file->length, capacity - file->length);
+
+          if (count < 0)
+          {
+               status = errno == EINTR;
+          }
+#endif
+          else if (count == 0)
+          {
+               done = true;
+          }
+          else
+          {
+               file->length += (size_t) count;
+          }
+     }
+
+     file->data = file->length > 0 ? file->buffer : NULL;
+
+     return status;
+}
+
+/**
+ * Unmaps (or frees) and closes a puzzle file. Safe to call on a file that failed to open.
+ *
+ * @param file SudokuPuzzleFile to close
+ */
+void closeSudokuPuzzleFile(SudokuPuzzleFile *file)
+{
+#ifdef _WIN32
+     if (file->data && file->buffer == NULL)
+     {
+          UnmapViewOfFile(file->data);
+     }
+     if (file->mappingHandle)
+     {
+          CloseHandle(file->mappingHandle);
+     }
+     if (file->fileHandle && file->fileHandle != INVALID_HANDLE_VALUE)
+     {
+          CloseHandle(file->fileHandle);
+     }
+#else
+     if (file->data && file->buffer == NULL)
+     {
+          munmap((void*) file->data, file->length);
+     }
+     if (file->descriptor >= 0)
+     {
+          close(file->descriptor);
+     }
+#endif
+
+     free(file->buffer);
+     memset(file, 0, sizeof(*file));
+
+#ifndef _WIN32
+     file->descriptor = -1;
+#endif
+}
+
+/**
+ * Index of the least-significant '1' bit in a non-zero mask
+ */
+unsigned lowestSetBitIndex(unsigned mask)
+{
+#ifdef _MSC_VER
+     unsigned long index;
+     _BitScanForward(&index, mask);
+     return index;
+#else
+     return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * Copies the digits found in a block of text into consecutive sudoku squares, converting them
+ * from ASCII to integer values. Every character that isn't a digit is skipped, which gives the
+ * permissive "ignore separators" behavior described by the 'load' command's help text.
+ *
+ * Text is classified 16 (SSE2) or 32 (AVX2) bytes at a time: one comparison marks which bytes
+ * are digits, and the marked bytes are then compacted directly into 'squares'. A block made up
+ * entirely of digits, as in an unseparated puzzle file, is stored with a single instruction.
+ *
+ * @param text Text to scan
+ * @param length Number of bytes in 'text'
+ * @param squares Receives the digit values
+ * @param squareCount Maximum number of digits to store
+ * @param consumed Receives the number of bytes of 'text' scanned, up to and including the last
+ *        digit stored if 'squares' was filled
+ * @return Number of digits stored
+ */
+size_t scanSudokuDigits(const char *text, size_t length, char *squares, size_t squareCount, size_t *consumed)
+{
+     size_t position = 0, filled = 0;
+     bool full = squareCount == 0;
+
+#if defined(__AVX2__)
+     const __m256i zeroChars = _mm256_set1_epi8('0'), nines = _mm256_set1_epi8(9);
+
+     while (!full && position + 32 <= length)
+     {
+          __m256i values = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*) (text + position)), zeroChars);
+          // unsigned min: bytes below '0' wrap around to large values, so they fail too
+          unsigned mask = (unsigned) _mm256_movemask_epi8(
+               _mm256_cmpeq_epi8(_mm256_min_epu8(values, nines), values));
+
+          if (mask == 0xFFFFFFFFu && squareCount - filled >= 32)
+          {
+               _mm256_storeu_si256((__m256i*) (squares + filled), values);
+               filled += 32;
+               position += 32;
+               full = filled == squareCount;
+          }
+          else
+          {
+               unsigned index = 0;
+
+               while (mask && !full)
+               {
+                    index = lowestSetBitIndex(mask);
+                    squares[filled++] = text[position + index] - '0';
+                    mask &= mask - 1;
+                    full = filled == squareCount;
+               }
+
+               position += full ? index + 1 : 32;
+          }
+     }
+#endif
+
+#ifdef SUDOKU_READER_SSE2
+     {
+          const __m128i zeroChars = _mm_set1_epi8('0'), nines = _mm_set1_epi8(9);
+
+          while (!full && position + 16 <= length)
+          {
+               __m128i values = _mm_sub_epi8(_mm_loadu_si128((const __m128i*) (text + position)), zeroChars);
+               // unsigned min: bytes below '0' wrap around to large values, so they fail too
+               unsigned mask = (unsigned) _mm_movemask_epi8(
+                    _mm_cmpeq_epi8(_mm_min_epu8(values, nines), values));
+
+               if (mask == 0xFFFF && squareCount - filled >= 16)
+               {
+                    _mm_storeu_si128((__m128i*) (squares + filled), values);
+                    filled += 16;
+                    position += 16;
+                    full = filled == squareCount;
+               }
+               else
+               {
+                    unsigned index = 0;
+
+                    while (mask && !full)
+                    {
+                         index = lowestSetBitIndex(mask);
+                         squares[filled++] = text[position + index] - '0';
+                         mask &= mask - 1;
+                         full = filled == squareCount;
+                    }
+
+                    position += full ? index + 1 : 16;
+               }
+          }
+     }
+#endif
+
+     // whatever is left over (or everything, without SIMD support) is scanned a byte at a time
+     while (!full && position < length)
+     {
+          if (text[position] >= '0' && text[position] <= '9')
+          {
+               squares[filled++] = text[position] - '0';
+               full = filled == squareCount;
+          }
+
+          ++position;
+     }
+
+     *consumed = position;
+
+     return filled;
+}
+
+/**
+ * Reads the next board from a puzzle file, following the same rules as the 'load' command:
+ * the next 81 digits in the file fill the board left to right, top to bottom, and every other
+ * character is ignored. If the file runs out of digits, the remaining squares are blank.
+ *
+ * @param file Puzzle file to read from
+ * @param contents Receives the board contents
+ * @return Number of squares read from the file (0 once the file is exhausted)
+ */
+size_t readNextSudokuBoard(SudokuPuzzleFile *file, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
+{
+     size_t consumed = 0, filled = 0;
+
+     if (file->position < file->length)
+     {
+          filled = scanSudokuDigits(file->data + file->position, file->length - file->position,
+               contents[0], SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT, &consumed);
+          file->position += consumed;
+     }
+
+     // blank out any squares the file didn't have digits for
+     memset(contents[0] + filled, 0, SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT - filled);
+
+     return filled;
+}
+
+/**
+ * Finds the next line of a puzzle file. The line points into the mapped file, so nothing is copied.
+ *
+ * @param file Puzzle file to read from
+ * @param line Receives the start of the line
+ * @param length Receives the length of the line, not counting the line ending
+ * @return False once there are no more lines
+ */
+bool readSudokuFileLine(SudokuPuzzleFile *file, const char **line, size_t *length)
+{
+     bool status = file->position < file->length;
+
+     if (status)
+     {
+          const char *start = file->data + file->position,
+               *end = memchr(start, '\n', file->length - file->position);
+
+          if (end)
+          {
+               *length = end - start;
+               file->position += *length + 1;
+          }
+          else
+          {
+               // last line of the file has no line ending
+               *length = file->length - file->position;
+               file->position = file->length;
+          }
+
+          // Windows line endings
+          if (*length > 0 && start[*length - 1] == '\r')
+          {
+               --*length;
+          }
+
+          *line = start;
+     }
+
+     return status;
+}
+
+/**
+ * Reads a puzzle written as a single line of text: exactly 81 characters, each a digit or '.'
+ * ('0' and '.' are blank squares). The whole line is checked and converted 16 bytes at a time.
+ *
+ * @param line Start of the line (need not be null-terminated)
+ * @param length Length of the line, not counting the line ending
+ * @param contents Receives the board contents
+ * @return True if the line held exactly 81 squares and nothing else
+ */
+bool parseSudokuBoardLine(const char *line, size_t length, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
+{
+     bool valid = length == SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT;
+     char *squares = contents[0];
+     size_t i = 0;
+
+#ifdef SUDOKU_READER_SSE2
+     const __m128i zeroChars = _mm_set1_epi8('0'), nines = _mm_set1_epi8(9), dots = _mm_set1_epi8('.');
+
+     for (; valid && i + 16 <= length; i += 16)
+     {
+          __m128i bytes = _mm_loadu_si128((const __m128i*) (line + i)),
+               values = _mm_sub_epi8(bytes, zeroChars),
+               isDot = _mm_cmpeq_epi8(bytes, dots),
+               isDigit = _mm_cmpeq_epi8(_mm_min_epu8(values, nines), values);
+
+          valid = _mm_movemask_epi8(_mm_or_si128(isDigit, isDot)) == 0xFFFF;
+
+          // dots become 0 (blank); digits keep their value
+          _mm_storeu_si128((__m128i*) (squares + i), _mm_andnot_si128(isDot, values));
+     }
+#endif
+
+     for (; valid && i < length; ++i)
+     {
+          if (line[i] >= '0' && line[i] <= '9')
+          {
+               squares[i] = SUDOKU_DIGIT_CHAR_TO_VALUE(line[i]);
+          }
+          else if (line[i] == '.')
+          {
+               squares[i] = 0;
+          }
+          else
+          {
+               valid = false;
+          }
+     }
+
+     return valid;
+}
+
+/**
+ * Checks whether a puzzle file holds one board per line (the format used by batch mode), as
+ * opposed to boards written as runs of digits. Only the first line that isn't blank or a
+ * '#' comment is looked at. The file's read position is unchanged.
+ *
+ * @param file Puzzle file to check
+ * @return True if the first board line is a single-line board
+ */
+bool isSudokuLineFile(const SudokuPuzzleFile *file)
+{
+     SudokuPuzzleFile peek = *file;
+     char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     const char *line;
+     size_t lineLength;
+     bool found = false, lineFormat = false;
+
+     while (!found && readSudokuFileLine(&peek, &line, &lineLength))
+     {
+          if (lineLength > 0 && line[0] != '#')
+          {
+               found = true;
+               lineFormat = parseSudokuBoardLine(line, lineLength, contents);
+          }
+     }
+
+     return lineFormat;
+}
+
+/**
+ * Reads the next board from a file holding one board per line. Blank lines, '#' comments and
+ * lines that aren't a single-line board are skipped.
+ *
+ * @param file Puzzle file to read from
+ * @param contents Receives the board contents
+ * @return False once the file has no more boards
+ */
+bool readNextSudokuBoardLine(SudokuPuzzleFile *file, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
+{
+     const char *line;
+     size_t lineLength;
+     bool found = false;
+
+     while (!found && readSudokuFileLine(file, &line, &lineLength))
+     {
+          found = lineLength > 0 && line[0] != '#' && parseSudokuBoardLine(line, lineLength, contents);
+     }
+
+     return found;
+}
@@ -0,0 +1,45 @@
+#ifndef SUDOKU_READER_H
+#define SUDOKU_READER_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "sudoku_utility.h"
+
+/**
+ * A puzzle file mapped into memory. Puzzles are parsed straight out of the mapping, so reading
+ * a file holding thousands of boards needs no read buffer and no per-character I/O calls.
+ * (pipes and devices can't be mapped, and are read into 'buffer' instead)
+ */
+struct SudokuPuzzleFile {
+     const char *data;     /**< file contents (NOT null-terminated); NULL for an empty file */
+     size_t length;        /**< number of bytes in 'data' */
+     size_t position;      /**< offset of the next byte to parse */
+     char *buffer;         /**< contents read from a pipe or device; NULL for a mapped file */
+#ifdef _WIN32
+     void *fileHandle;     /**< HANDLE of the open file */
+     void *mappingHandle;  /**< HANDLE of the file mapping */
+#else
+     int descriptor;       /**< descriptor of the open file */
+#endif
+};
+
+typedef struct SudokuPuzzleFile SudokuPuzzleFile;
+
+bool openSudokuPuzzleFile(SudokuPuzzleFile *file, const char *fileName);
+
+void closeSudokuPuzzleFile(SudokuPuzzleFile *file);
+
+size_t scanSudokuDigits(const char *text, size_t length, char *squares, size_t squareCount, size_t *consumed);
+
+size_t readNextSudokuBoard(SudokuPuzzleFile *file, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]);
+
+bool readSudokuFileLine(SudokuPuzzleFile *file, const char **line, size_t *length);
+
+bool parseSudokuBoardLine(const char *line, size_t length, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]);
+
+bool isSudokuLineFile(const SudokuPuzzleFile *file);
+
+bool readNextSudokuBoardLine(SudokuPuzzleFile *file, char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]);
+
+#endif // !SUDOKU_READER_H
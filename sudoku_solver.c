@@ -0,0 +1,554 @@
+/******************************************************************************
+ * Program: sudoku_solver.c
+ *
+ * Purpose: Search engine that finds a complete solution for a sudoku board,
+ *          using constraint propagation plus depth-first backtracking
+ *
+ *****************************************************************************/
+#include <memory.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "sudoku_solver.h"
+#include "sudoku_test_digits.h"
+#include "sudoku_utility.h"
+
+/**
+ * Result of running constraint propagation on a search state
+ */
+enum SudokuPropagationResult {
+     SUDOKU_PROPAGATION_CONTRADICTION,  /**< some square or digit has nowhere left to go */
+     SUDOKU_PROPAGATION_SOLVED,         /**< every square is filled */
+     SUDOKU_PROPAGATION_BRANCH,         /**< no more forced moves; a guess is required */
+};
+
+/**
+ * Everything the search needs to know about a partially-filled board. Small enough that each
+ * level of the search simply works on its own copy, so backtracking is just "throw the copy away".
+ */
+struct SudokuSearchState {
+     char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+     DigitsPresent digitsPresent;  /**< digits present in each row, column and block */
+     int blankCount;               /**< number of squares still holding 0 */
+};
+
+typedef struct SudokuSearchState SudokuSearchState;
+
+
+bool initializeSearchState(SudokuSearchState *state, const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]);
+void placeSearchDigit(SudokuSearchState *state, int row, int column, int digit);
+enum SudokuPropagationResult propagateConstraints(SudokuSearchState *state, Coord2D *branchSquare);
+bool searchForSolution(SudokuSearchState *state, SudokuSolverStats *stats);
+void countSolutionsFrom(SudokuSearchState *state, unsigned long limit, unsigned long *count, SudokuSolverStats *stats);
+
+
+/**
+ * Finds a complete solution for a sudoku board. The board itself is not modified.
+ *
+ * @param contents Board contents to solve (0 for blank squares)
+ * @param solution Receives the solved board if a solution exists
+ * @param stats Optional counters for the work done by the search (may be NULL)
+ * @return True if a solution was found, false if the board cannot be solved
+ */
+bool solveSudokuBoardContents(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT],
+     char solution[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], SudokuSolverStats *stats)
+{
+     SudokuSearchState state;
+     SudokuSolverStats localStats = { 0 };
+     bool solved = false;
+
+     if (stats == NULL)
+     {
+          stats = &localStats;
+     }
+
+     stats->nodes = 0;
+     stats->backtracks = 0;
+
+     // a board with illegal or repeated digits has no solution, so don't bother searching
+     if (initializeSearchState(&state, contents))
+     {
+          if (searchForSolution(&state, stats))
+          {
+               memcpy(solution, state.contents, sizeof(state.contents));
+               solved = true;
+          }
+     }
+
+     return solved;
+}
+
+/**
+ * Counts the solutions of a sudoku board, stopping as soon as 'limit' have been found. A limit
+ * of 2 is enough to tell whether a puzzle has a unique solution.
+ *
+ * @param contents Board contents to examine (0 for blank squares)
+ * @param limit Stop counting after this many solutions
+ * @param stats Optional counters for the work done by the search (may be NULL)
+ * @return Number of solutions found, at most 'limit'
+ */
+unsigned long countSudokuSolutions(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT],
+     unsigned long limit, SudokuSolverStats *stats)
+{
+     SudokuSearchState state;
+     SudokuSolverStats localStats = { 0 };
+     unsigned long count = 0;
+
+     if (stats == NULL)
+     {
+          stats = &localStats;
+     }
+
+     stats->nodes = 0;
+     stats->backtracks = 0;
+
+     if (limit > 0 && initializeSearchState(&state, contents))
+     {
+          countSolutionsFrom(&state, limit, &count, stats);
+     }
+
+     return count;
+}
+
+/**
+ * Splits the search for solutions into independent pieces, e.g. to hand out to several threads.
+ * The search tree is explored breadth-first, one branch point at a time, until there are at least
+ * 'targetCount' open branches (or none left). Every solution of the board is a solution of
+ * exactly one piece, apart from any found outright while splitting.
+ *
+ * @param contents Board contents to split (0 for blank squares)
+ * @param targetCount Number of pieces wanted
+ * @param subproblems Receives a newly-allocated array of board contents, one per piece. The
+ *                    caller must free it (NULL if there are no pieces)
+ * @param solvedCount Receives the number of solutions found while splitting
+ * @return Number of pieces in 'subproblems'
+ */
+size_t splitSudokuSearch(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], size_t targetCount,
+     char (**subproblems)[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], unsigned long *solvedCount)
+{
+     // a branch point replaces one state with at most 9, so this is always enough room
+     size_t capacity = targetCount + SUDOKU_DIGIT_MAX + 1, head = 0, tail = 0, i;
+     SudokuSearchState *queue = malloc(sizeof(*queue) * capacity);
+     Coord2D branchSquare = { 0 };
+
+     *solvedCount = 0;
+     *subproblems = NULL;
+
+     if (queue == NULL)
+     {
+          terminate("ERROR: not enough memory to split the search");
+     }
+
+     if (initializeSearchState(&queue[tail], contents))
+     {
+          ++tail;
+     }
+
+     // queue is a sliding window [head, tail); stop once it holds enough open branches
+     while (head < tail && tail - head < targetCount)
+     {
+          SudokuSearchState state = queue[head++];
+          enum SudokuPropagationResult result = propagateConstraints(&state, &branchSquare);
+
+          if (result == SUDOKU_PROPAGATION_SOLVED)
+          {
+               ++*solvedCount;
+          }
+          else if (result == SUDOKU_PROPAGATION_BRANCH)
+          {
+               int row = branchSquare.row, column = branchSquare.col;
+               SudokuDigitTestField candidates = SUDOKU_TEST_ALLDIGITS &
+                    ~(state.digitsPresent.rows[row] | state.digitsPresent.columns[column] |
+                      state.digitsPresent.blocks[SUDOKU_BLOCK_FROM_INTERSECTION(row, column)]);
+
+               // slide the window back to the start of the array, so it never runs off the end
+               if (tail + SUDOKU_DIGIT_MAX > capacity)
+               {
+                    memmove(queue, queue + head, sizeof(*queue) * (tail - head));
+                    tail -= head;
+                    head = 0;
+               }
+
+               while (candidates)
+               {
+                    queue[tail] = state;
+                    placeSearchDigit(&queue[tail++], row, column, lowestDigitFromFlags(candidates));
+                    candidates &= candidates - 1;
+               }
+          }
+     }
+
+     if (tail > head)
+     {
+          *subproblems = malloc(sizeof(**subproblems) * (tail - head));
+
+          if (*subproblems == NULL)
+          {
+               terminate("ERROR: not enough memory to split the search");
+          }
+
+          for (i = head; i < tail; ++i)
+          {
+               memcpy((*subproblems)[i - head], queue[i].contents, sizeof(queue[i].contents));
+          }
+     }
+
+     free(queue);
+
+     return tail - head;
+}
+
+/**
+ * Counts how many digits are flagged in a SudokuDigitTestField
+ *
+ * @param field Bit-field to count
+ * @return Number of '1' bits in the field
+ */
+int countDigitFlags(SudokuDigitTestField field)
+{
+#ifdef __GNUC__
+     return __builtin_popcount((unsigned) field);
+#else
+     int count = 0;
+
+     // each iteration clears the lowest set bit
+     while (field)
+     {
+          field &= field - 1;
+          ++count;
+     }
+
+     return count;
+#endif
+}
+
+/**
+ * Finds the smallest digit flagged in a SudokuDigitTestField
+ *
+ * @param field Bit-field to examine
+ * @return Smallest digit flagged in the field, or 0 if no digits are flagged
+ */
+int lowestDigitFromFlags(SudokuDigitTestField field)
+{
+     int digit = 0;
+
+     if (field)
+     {
+          // first digit has place-value 0, so start at 1 and shift until the flag is found
+          for (digit = 1; !(field & 1); ++digit)
+          {
+               field >>= 1;
+          }
+     }
+
+     return digit;
+}
+
+/**
+ * Builds the starting search state from a board's contents
+ *
+ * @return False if the board contains an illegal digit, or a digit repeated in a row, column,
+ *         or block (either way, there is no solution)
+ */
+bool initializeSearchState(SudokuSearchState *state, const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
+{
+     bool valid = true;
+     int row, column, digit;
+
+     memset(state, 0, sizeof(*state));
+
+     for (row = 0; valid && row < SUDOKU_ROW_COUNT; ++row)
+     {
+          for (column = 0; valid && column < SUDOKU_COL_COUNT; ++column)
+          {
+               digit = contents[row][column];
+
+               if (digit == 0)
+               {
+                    ++state->blankCount;
+               }
+               else if (digit < 0 || digit > SUDOKU_DIGIT_MAX)
+               {
+                    valid = false;
+               }
+               else
+               {
+                    SudokuDigitTestField flag = SUDOKU_TEST_FLAG_SHIFT(digit);
+                    int block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column);
+
+                    // a digit already present in any of the square's units is a repeat
+                    if ((state->digitsPresent.rows[row] | state->digitsPresent.columns[column] |
+                         state->digitsPresent.blocks[block]) & flag)
+                    {
+                         valid = false;
+                    }
+                    else
+                    {
+                         placeSearchDigit(state, row, column, digit);
+                         // placeSearchDigit assumes it's filling a blank
+                         ++state->blankCount;
+                    }
+               }
+          }
+     }
+
+     return valid;
+}
+
+/**
+ * Fills a blank square and records the digit in the square's row, column, and block
+ */
+void placeSearchDigit(SudokuSearchState *state, int row, int column, int digit)
+{
+     SudokuDigitTestField flag = SUDOKU_TEST_FLAG_SHIFT(digit);
+
+     state->contents[row][column] = digit;
+     state->digitsPresent.rows[row] |= flag;
+     state->digitsPresent.columns[column] |= flag;
+     state->digitsPresent.blocks[SUDOKU_BLOCK_FROM_INTERSECTION(row, column)] |= flag;
+     --state->blankCount;
+}
+
+/**
+ * Repeatedly fills squares that are forced (naked singles and hidden singles) until no more
+ * forced moves remain. If the board still isn't solved, reports the blank square with the fewest
+ * candidates, so the search can branch on it (minimum-remaining-values heuristic).
+ *
+ * @param state Search state that will be updated in place
+ * @param branchSquare Receives the square to branch on, if the result is BRANCH
+ * @return Whether the board was solved, needs a guess, or contains a contradiction
+ */
+enum SudokuPropagationResult propagateConstraints(SudokuSearchState *state, Coord2D *branchSquare)
+{
+     enum SudokuPropagationResult result = SUDOKU_PROPAGATION_BRANCH;
+     DigitsPresent *present = &state->digitsPresent;
+     bool progress = true;
+     int row, column, block, unit, i, candidateCount, fewestCandidates = 0;
+     SudokuDigitTestField candidates;
+
+     while (progress && result != SUDOKU_PROPAGATION_CONTRADICTION && state->blankCount > 0)
+     {
+          progress = false;
+          fewestCandidates = SUDOKU_DIGIT_MAX + 1;
+
+          // naked singles: squares with exactly one candidate
+          for (row = 0; result != SUDOKU_PROPAGATION_CONTRADICTION && row < SUDOKU_ROW_COUNT; ++row)
+          {
+               for (column = 0; result != SUDOKU_PROPAGATION_CONTRADICTION && column < SUDOKU_COL_COUNT; ++column)
+               {
+                    if (state->contents[row][column] == 0)
+                    {
+                         block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column);
+                         candidates = SUDOKU_TEST_ALLDIGITS &
+                              ~(present->rows[row] | present->columns[column] | present->blocks[block]);
+                         candidateCount = countDigitFlags(candidates);
+
+                         if (candidateCount == 0)
+                         {
+                              result = SUDOKU_PROPAGATION_CONTRADICTION;
+                         }
+                         else if (candidateCount == 1)
+                         {
+                              placeSearchDigit(state, row, column, lowestDigitFromFlags(candidates));
+                              progress = true;
+                         }
+                         else if (candidateCount < fewestCandidates)
+                         {
+                              fewestCandidates = candidateCount;
+                              branchSquare->row = row;
+                              branchSquare->col = column;
+                         }
+                    }
+               }
+          }
+
+          // hidden singles: digits that fit in only one square of a row, column, or block.
+          // rows are units 0-8, columns are units 9-17, blocks are units 18-26
+          for (unit = 0;
+               !progress && result != SUDOKU_PROPAGATION_CONTRADICTION &&
+               unit < SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT + SUDOKU_BLOCK_COUNT;
+               ++unit)
+          {
+               SudokuDigitTestField seenOnce = 0, seenTwice = 0, unitPresent, hidden;
+               int squareRows[SUDOKU_DIGIT_MAX], squareColumns[SUDOKU_DIGIT_MAX];
+
+               for (i = 0; i < SUDOKU_DIGIT_MAX; ++i)
+               {
+                    if (unit < SUDOKU_ROW_COUNT)
+                    {
+                         squareRows[i] = unit;
+                         squareColumns[i] = i;
+                    }
+                    else if (unit < SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT)
+                    {
+                         squareRows[i] = i;
+                         squareColumns[i] = unit - SUDOKU_ROW_COUNT;
+                    }
+                    else
+                    {
+                         block = unit - SUDOKU_ROW_COUNT - SUDOKU_COL_COUNT;
+                         squareRows[i] = (block / 3) * 3 + i / 3;
+                         squareColumns[i] = (block % 3) * 3 + i % 3;
+                    }
+               }
+
+               for (i = 0; i < SUDOKU_DIGIT_MAX; ++i)
+               {
+                    row = squareRows[i];
+                    column = squareColumns[i];
+
+                    if (state->contents[row][column] == 0)
+                    {
+                         block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column);
+                         candidates = SUDOKU_TEST_ALLDIGITS &
+                              ~(present->rows[row] | present->columns[column] | present->blocks[block]);
+
+                         seenTwice |= seenOnce & candidates;
+                         seenOnce |= candidates;
+                    }
+               }
+
+               // every digit must be either present in the unit or possible somewhere inside it
+               if (unit < SUDOKU_ROW_COUNT)
+               {
+                    unitPresent = present->rows[unit];
+               }
+               else if (unit < SUDOKU_ROW_COUNT + SUDOKU_COL_COUNT)
+               {
+                    unitPresent = present->columns[unit - SUDOKU_ROW_COUNT];
+               }
+               else
+               {
+                    unitPresent = present->blocks[unit - SUDOKU_ROW_COUNT - SUDOKU_COL_COUNT];
+               }
+
+               hidden = seenOnce & ~seenTwice;
+
+               if ((seenOnce | unitPresent) != SUDOKU_TEST_ALLDIGITS)
+               {
+                    result = SUDOKU_PROPAGATION_CONTRADICTION;
+               }
+               else if (hidden)
+               {
+                    SudokuDigitTestField flag = hidden & -hidden;
+
+                    // find the one square in the unit where the lowest hidden digit fits
+                    for (i = 0; !progress && i < SUDOKU_DIGIT_MAX; ++i)
+                    {
+                         row = squareRows[i];
+                         column = squareColumns[i];
+                         block = SUDOKU_BLOCK_FROM_INTERSECTION(row, column);
+
+                         if (state->contents[row][column] == 0 &&
+                             !((present->rows[row] | present->columns[column] | present->blocks[block]) & flag))
+                         {
+                              placeSearchDigit(state, row, column, lowestDigitFromFlags(flag));
+                              progress = true;
+                         }
+                    }
+               }
+          }
+     }
+
+     if (result != SUDOKU_PROPAGATION_CONTRADICTION && state->blankCount == 0)
+     {
+          result = SUDOKU_PROPAGATION_SOLVED;
+     }
+
+     return result;
+}
+
+/**
+ * Depth-first search: propagate forced moves, then try each candidate of the most constrained
+ * square in turn. Each guess works on a copy of the state, so a failed guess needs no cleanup.
+ *
+ * @param state Search state; holds the solution on success
+ * @param stats Counters for guesses and backtracks
+ * @return True if a solution was found
+ */
+bool searchForSolution(SudokuSearchState *state, SudokuSolverStats *stats)
+{
+     bool solved = false;
+     Coord2D branchSquare = { 0 };
+     enum SudokuPropagationResult result = propagateConstraints(state, &branchSquare);
+
+     if (result == SUDOKU_PROPAGATION_SOLVED)
+     {
+          solved = true;
+     }
+     else if (result == SUDOKU_PROPAGATION_BRANCH)
+     {
+          int row = branchSquare.row, column = branchSquare.col;
+          SudokuDigitTestField candidates = SUDOKU_TEST_ALLDIGITS &
+               ~(state->digitsPresent.rows[row] | state->digitsPresent.columns[column] |
+                 state->digitsPresent.blocks[SUDOKU_BLOCK_FROM_INTERSECTION(row, column)]);
+
+          while (!solved && candidates)
+          {
+               SudokuSearchState guess = *state;
+               int digit = lowestDigitFromFlags(candidates);
+
+               // remove this candidate, so the next iteration tries the following one
+               candidates &= candidates - 1;
+
+               ++stats->nodes;
+               placeSearchDigit(&guess, row, column, digit);
+
+               if (searchForSolution(&guess, stats))
+               {
+                    *state = guess;
+                    solved = true;
+               }
+               else
+               {
+                    ++stats->backtracks;
+               }
+          }
+     }
+
+     return solved;
+}
+
+/**
+ * Same search as searchForSolution, but keeps going after a solution is found, until every
+ * branch has been tried or 'limit' solutions have been counted
+ *
+ * @param state Search state to start from
+ * @param limit Stop counting after this many solutions
+ * @param count Incremented for each solution found
+ * @param stats Counters for guesses and backtracks
+ */
+void countSolutionsFrom(SudokuSearchState *state, unsigned long limit, unsigned long *count, SudokuSolverStats *stats)
+{
+     Coord2D branchSquare = { 0 };
+     enum SudokuPropagationResult result = propagateConstraints(state, &branchSquare);
+
+     if (result == SUDOKU_PROPAGATION_SOLVED)
+     {
+          ++*count;
+     }
+     else if (result == SUDOKU_PROPAGATION_BRANCH)
+     {
+          int row = branchSquare.row, column = branchSquare.col;
+          SudokuDigitTestField candidates = SUDOKU_TEST_ALLDIGITS &
+               ~(state->digitsPresent.rows[row] | state->digitsPresent.columns[column] |
+                 state->digitsPresent.blocks[SUDOKU_BLOCK_FROM_INTERSECTION(row, column)]);
+
+          while (*count < limit && candidates)
+          {
+               SudokuSearchState guess = *state;
+               unsigned long countBefore = *count;
+
+               ++stats->nodes;
+               placeSearchDigit(&guess, row, column, lowestDigitFromFlags(candidates));
+               candidates &= candidates - 1;
+
+               countSolutionsFrom(&guess, limit, count, stats);
+
+               if (*count == countBefore)
+               {
+                    ++stats->backtracks;
+               }
+          }
+     }
+}
@@ -0,0 +1,32 @@
+#ifndef SUDOKU_SOLVER_H
+#define SUDOKU_SOLVER_H
+
+#include <stdbool.h>
+
+#include "sudoku_test_digits.h"
+#include "sudoku_utility.h"
+
+/**
+ * Counters describing how much work the search engine had to do to reach its answer
+ */
+struct SudokuSolverStats {
+     unsigned long nodes;      /**< number of guesses tried at branch points */
+     unsigned long backtracks; /**< number of guesses that led to a contradiction */
+};
+
+typedef struct SudokuSolverStats SudokuSolverStats;
+
+bool solveSudokuBoardContents(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT],
+     char solution[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], SudokuSolverStats *stats);
+
+unsigned long countSudokuSolutions(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT],
+     unsigned long limit, SudokuSolverStats *stats);
+
+size_t splitSudokuSearch(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], size_t targetCount,
+     char (**subproblems)[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], unsigned long *solvedCount);
+
+int countDigitFlags(SudokuDigitTestField field);
+
+int lowestDigitFromFlags(SudokuDigitTestField field);
+
+#endif // !SUDOKU_SOLVER_H
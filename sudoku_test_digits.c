@@ -13,6 +13,13 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+// pshufb (SSSE3) turns 16 squares into digit flags at once. MSVC doesn't announce SSSE3 on its
+// own, but any target with AVX has it too
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define SUDOKU_VALIDATE_SSSE3
+#endif
+
 #include "sudoku_board.h"
 #include "sudoku_test_digits.h"
 
@@ -27,6 +34,9 @@ enum SUDOKU_COLLECTION_TYPE {
 };
 
 
+void scanUnitDigits(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], struct DigitsPresent *digitsPresent,
+     bool recordIllegalOrBlank);
+void walkDigitsPresent(struct SudokuBoard *board, struct DigitsPresent *digitsPresent, bool verbose);
 void reportIllegalDigit(int row, int col, int value);
 void reportRepeatedDigit(enum SUDOKU_COLLECTION_TYPE type, int row, int col, int block, int value);
 void reportBlankSquare(int row, int col);
@@ -103,6 +113,209 @@ else
  * @param verbose If true, results of analysis will be printed to the screen.
  */
 void evaluateDigitsPresent(struct SudokuBoard *board, struct DigitsPresent *digitsPresent, bool verbose)
+{
+     // one pass over the board fills in every result. Walking each row, column and block
+     // separately is only needed to report what's wrong with a board that isn't a solution
+     if (!computeDigitsPresent(board->contents, digitsPresent))
+     {
+          if (verbose)
+          {
+               walkDigitsPresent(board, digitsPresent, verbose);
+          }
+     }
+     else if (verbose)
+     {
+          printf("Sudoku solution is valid!\n");
+     }
+}
+
+/**
+ * Fast, silent version of evaluateDigitsPresent: fills in a DigitsPresent struct in a single
+ * pass over the board, with no branches on the square values.
+ *
+ * @param contents Board contents to analyze
+ * @param digitsPresent Pointer to the DigitsPresent struct that will store the results
+ * @return True if the board is a valid, complete solution
+ */
+bool computeDigitsPresent(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], struct DigitsPresent *digitsPresent)
+{
+     SudokuDigitTestField allUnits = SUDOKU_TEST_ALLDIGITS;
+     int i;
+
+     scanUnitDigits(contents, digitsPresent, true);
+
+     for (i = 0; i < SUDOKU_ROW_COUNT; ++i)
+     {
+          allUnits &= digitsPresent->rows[i] & digitsPresent->columns[i] & digitsPresent->blocks[i];
+     }
+
+     // 9 squares can only have all 9 flags if they hold 9 different digits
+     return allUnits == SUDOKU_TEST_ALLDIGITS;
+}
+
+/**
+ * Checks whether board contents are a valid, complete sudoku solution, without reporting why not
+ *
+ * @param contents Board contents to check
+ * @return True if every row, column and block holds each digit from 1 to 9 exactly once
+ */
+bool isSudokuSolutionValid(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
+{
+     struct DigitsPresent digitsPresent;
+     SudokuDigitTestField allUnits = SUDOKU_TEST_ALLDIGITS;
+     int i;
+
+     scanUnitDigits(contents, &digitsPresent, false);
+
+     for (i = 0; i < SUDOKU_ROW_COUNT; ++i)
+     {
+          allUnits &= digitsPresent.rows[i] & digitsPresent.columns[i] & digitsPresent.blocks[i];
+     }
+
+     return allUnits == SUDOKU_TEST_ALLDIGITS;
+}
+
+/**
+ * Checks many boards at once, e.g. the output of a batch solve
+ *
+ * @param solutions Board contents to check, one after another
+ * @param count Number of boards in 'solutions'
+ * @param isValid Receives the result for each board (may be NULL if only the total is wanted)
+ * @return Number of boards that are valid, complete solutions
+ */
+size_t validateSudokuSolutions(const char solutions[][SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], size_t count, bool *isValid)
+{
+     size_t i, validCount = 0;
+     bool valid;
+
+     for (i = 0; i < count; ++i)
+     {
+          valid = isSudokuSolutionValid(solutions[i]);
+          validCount += valid;
+
+          if (isValid)
+          {
+               isValid[i] = valid;
+          }
+     }
+
+     return validCount;
+}
+
+/**
+ * Computes the digit flags of all 27 units in a single pass over the board. A square that is
+ * blank or illegal contributes no flag.
+ * Inner function of 'computeDigitsPresent' and 'isSudokuSolutionValid'
+ *
+ * @param contents Board contents to analyze
+ * @param digitsPresent Receives the flags of every unit
+ * @param recordIllegalOrBlank Whether to fill in 'squaresIllegalOrBlank' as well
+ */
+void scanUnitDigits(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], struct DigitsPresent *digitsPresent,
+     bool recordIllegalOrBlank)
+{
+#ifdef SUDOKU_VALIDATE_SSSE3
+     // flags for values 0-9 split into low and high bytes; values of 10 or more (including
+     // negative values, as unsigned bytes) are clamped to 10, which has no flag
+     const __m128i lowFlags = _mm_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64, (char) 128, 0, 0, 0, 0, 0, 0, 0),
+          highFlags = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0),
+          illegalValue = _mm_set1_epi8(SUDOKU_DIGIT_MAX + 1), zero = _mm_setzero_si128(), ones = _mm_set1_epi8(1);
+     __m128i columnsLow = zero, columnsHigh = zero, blockLow = zero, blockHigh = zero;
+     // room to load 16 bytes starting at the last row
+     char padded[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT + 16];
+     unsigned short columnFlags[8];
+     bool illegalOrBlank[16];
+     int row, column;
+
+     memcpy(padded, contents[0], SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT);
+     memset(padded + SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT, 0, 16);
+
+     for (row = 0; row < SUDOKU_ROW_COUNT; ++row)
+     {
+          __m128i values = _mm_min_epu8(_mm_loadu_si128((const __m128i*) (padded + row * SUDOKU_COL_COUNT)), illegalValue),
+               low = _mm_shuffle_epi8(lowFlags, values),
+               high = _mm_shuffle_epi8(highFlags, values),
+               // 16-bit flags: squares 0-7 of the row, then square 8 in the first lane
+               flagsLow = _mm_unpacklo_epi8(low, high),
+               flagsHigh = _mm_unpackhi_epi8(low, high),
+               rowFlags;
+
+          columnsLow = _mm_or_si128(columnsLow, flagsLow);
+          columnsHigh = _mm_or_si128(columnsHigh, flagsHigh);
+          blockLow = _mm_or_si128(blockLow, flagsLow);
+          blockHigh = _mm_or_si128(blockHigh, flagsHigh);
+
+          rowFlags = _mm_or_si128(flagsLow, _mm_srli_si128(flagsLow, 8));
+          rowFlags = _mm_or_si128(rowFlags, _mm_srli_si128(rowFlags, 4));
+          rowFlags = _mm_or_si128(rowFlags, _mm_srli_si128(rowFlags, 2));
+          digitsPresent->rows[row] = _mm_extract_epi16(rowFlags, 0) | _mm_extract_epi16(flagsHigh, 0);
+
+          if (recordIllegalOrBlank)
+          {
+               _mm_storeu_si128((__m128i*) illegalOrBlank, _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(low, high), zero), ones));
+               memcpy(digitsPresent->squaresIllegalOrBlank[row], illegalOrBlank, SUDOKU_COL_COUNT);
+          }
+
+          // last row of a band of blocks: lanes 0-2, 3-5 and 6-8 each make up one block
+          if (row % SUDOKU_BLOCK_HEIGHT == SUDOKU_BLOCK_HEIGHT - 1)
+          {
+               blockLow = _mm_or_si128(blockLow, _mm_or_si128(_mm_srli_si128(blockLow, 2), _mm_srli_si128(blockLow, 4)));
+               digitsPresent->blocks[row - 2] = _mm_extract_epi16(blockLow, 0);
+               digitsPresent->blocks[row - 1] = _mm_extract_epi16(blockLow, 3);
+               digitsPresent->blocks[row] = _mm_extract_epi16(blockLow, 6) | _mm_extract_epi16(blockHigh, 0);
+
+               blockLow = blockHigh = zero;
+          }
+     }
+
+     _mm_storeu_si128((__m128i*) columnFlags, columnsLow);
+
+     for (column = 0; column < 8; ++column)
+     {
+          digitsPresent->columns[column] = columnFlags[column];
+     }
+
+     digitsPresent->columns[8] = _mm_extract_epi16(columnsHigh, 0);
+#else
+     // digit flag for each value, with values that aren't sudoku digits having no flag
+     static const SudokuDigitTestField digitFlags[SUDOKU_DIGIT_MAX + 1] = {
+          0, SUDOKU_TEST_1, SUDOKU_TEST_2, SUDOKU_TEST_3, SUDOKU_TEST_4,
+          SUDOKU_TEST_5, SUDOKU_TEST_6, SUDOKU_TEST_7, SUDOKU_TEST_8, SUDOKU_TEST_9,
+     };
+     const char *currentSquare = contents[0];
+     SudokuDigitTestField flag;
+     int i;
+
+     memset(digitsPresent->rows, 0, sizeof(digitsPresent->rows));
+     memset(digitsPresent->columns, 0, sizeof(digitsPresent->columns));
+     memset(digitsPresent->blocks, 0, sizeof(digitsPresent->blocks));
+
+     for (i = 0; i < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++i)
+     {
+          flag = (unsigned char) currentSquare[i] <= SUDOKU_DIGIT_MAX ? digitFlags[(unsigned char) currentSquare[i]] : 0;
+
+          digitsPresent->rows[sudokuSquareRow[i]] |= flag;
+          digitsPresent->columns[sudokuSquareColumn[i]] |= flag;
+          digitsPresent->blocks[sudokuSquareBlock[i]] |= flag;
+
+          if (recordIllegalOrBlank)
+          {
+               digitsPresent->squaresIllegalOrBlank[sudokuSquareRow[i]][sudokuSquareColumn[i]] = flag == 0;
+          }
+     }
+#endif
+}
+
+/**
+ * Walks through each row, column and block in turn, checking each square against the digits
+ * already seen and reporting every problem found.
+ * Inner function of 'evaluateDigitsPresent'
+ *
+ * @param board Pointer to the SudokuBoard to analyze
+ * @param digitsPresent Pointer to the DigitsPresent struct that will store the results
+ * @param verbose If true, results of analysis will be printed to the screen.
+ */
+void walkDigitsPresent(struct SudokuBoard *board, struct DigitsPresent *digitsPresent, bool verbose)
 {
      int i, j, k = 0, value;
      bool sudokuValid = true;
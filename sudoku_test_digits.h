@@ -3,7 +3,6 @@
 
 #include <stdbool.h>
 
-#include "sudoku_board.h"
 #include "sudoku_utility.h"
 
 struct SudokuBoard;
@@ -48,5 +47,11 @@ typedef struct DigitsPresent DigitsPresent;
 
 void evaluateDigitsPresent(struct SudokuBoard *board, struct DigitsPresent *digitsPresent, bool verbose);
 
+bool computeDigitsPresent(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], struct DigitsPresent *digitsPresent);
+
+bool isSudokuSolutionValid(const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT]);
+
+size_t validateSudokuSolutions(const char solutions[][SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT], size_t count, bool *isValid);
+
 #endif // !SUDOKU_TEST_DIGITS_H
 
@@ -9,9 +9,25 @@
  * Date: 5/13/16
  *
  *****************************************************************************/
+// ftruncate, fsync and fileno are POSIX, hidden from strict ISO C builds (-std=c11) unless asked
+// for before the first system header
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "sudoku_board.h"
+#include "sudoku_reader.h"
 #include "sudoku_undo.h"
 #include "sudoku_utility.h"
 
@@ -19,14 +35,90 @@
 // purposes. "clients" of the History ADT don't need to know how it's implemented,
 // only the functions they can call to make use of its functionality
 
+/**
+ * One HistoryStep packed into 16 bits:
+ *   bits  0-6:  square that changed (row * 9 + column)
+ *   bits  7-10: value of the square after the change
+ *   bits 11-14: value of the square before the change
+ *   bit  15:    set if the step belongs to the same group as the step above it (see
+ *               beginHistoryGroup), so the two are undone and redone together
+ */
+typedef unsigned short HistoryRecord;
+
+#define HISTORY_RECORD_PACK(row, column, newValue, oldValue) \
+     (HistoryRecord) (((row) * SUDOKU_COL_COUNT + (column)) | ((newValue) << 7) | ((oldValue) << 11))
+#define HISTORY_RECORD_ROW(record) (((record) & 0x7F) / SUDOKU_COL_COUNT)
+#define HISTORY_RECORD_COLUMN(record) (((record) & 0x7F) % SUDOKU_COL_COUNT)
+#define HISTORY_RECORD_NEW_VALUE(record) (((record) >> 7) & 0x0F)
+#define HISTORY_RECORD_OLD_VALUE(record) (((record) >> 11) & 0x0F)
+#define HISTORY_RECORD_CONTINUED 0x8000
+
+/** number of records in each chunk of a History. Chunks never move once allocated */
+#define HISTORY_CHUNK_SIZE 1024
+
+/** index of the last checkpoint taken at or before a step */
+#define HISTORY_CHECKPOINT_AT_STEP(history, step) ((step) / (history)->checkpointInterval)
+
+/** the record at a position in the History, counting from the bottom of the stack */
+#define HISTORY_RECORD_AT(history, index) \
+     (history)->chunks[(index) / HISTORY_CHUNK_SIZE][(index) % HISTORY_CHUNK_SIZE]
+
+/** the tree node of the step at a position on the current branch */
+#define HISTORY_PATH_NODE_AT(history, index) \
+     (history)->pathChunks[(index) / HISTORY_CHUNK_SIZE][(index) % HISTORY_CHUNK_SIZE]
+
+/** a node of the tree, by its index in the arena */
+#define HISTORY_NODE(history, index) \
+     (history)->nodeChunks[(index) / HISTORY_CHUNK_SIZE][(index) % HISTORY_CHUNK_SIZE]
+
+/**
+ * One step in the tree of every step ever made to a board. Nodes live in an arena of fixed-size
+ * chunks and refer to each other by index, so a node is 16 bytes and the whole tree is freed
+ * a chunk at a time. Node 0 is the root: the board before any step.
+ */
+struct HistoryNode {
+     unsigned parent;          /**< node of the step this one was made after */
+     unsigned firstChild;      /**< most recent step made after this one, or 0 if none */
+     unsigned nextSibling;     /**< next most recent step made after the same parent, or 0 */
+     HistoryRecord record;     /**< the step. Bit 15 means it joined its parent's group, since a
+                                    node's children may be in different groups */
+};
+
+typedef struct HistoryNode HistoryNode;
+
 /**
 * Struct representing the history of a sudoku board
 */
 struct HistoryStruct {
-     HistoryStep *steps;           /**< dynamically allocated array of HistorySteps */
-     HistoryStep *currentStep;     /**< off-the-end pointer to top of History stack */
-     size_t length;                /**< number of steps currently in history */
-     size_t capacity;              /**< number of elements allocated in 'steps' */
+     HistoryRecord **chunks;       /**< dynamically allocated array of pointers to fixed-size
+                                        chunks of records, so adding steps never copies old ones */
+     size_t chunkCount;            /**< number of chunks allocated */
+     size_t chunkCapacity;         /**< number of elements allocated in 'chunks' */
+     unsigned **pathChunks;        /**< tree node of each step in 'chunks', allocated alongside */
+     size_t currentStep;           /**< off-the-end index of top of History stack */
+     size_t length;                /**< number of steps on the current branch */
+
+     HistoryNode **nodeChunks;     /**< arena of fixed-size chunks holding the tree of steps; the
+                                        records in 'chunks' are the branch from the root to the
+                                        board, copied out so undo and redo read them in order */
+     size_t nodeChunkCount;        /**< number of node chunks allocated */
+     size_t nodeChunkCapacity;     /**< number of elements allocated in 'nodeChunks' */
+     size_t nodeCount;             /**< number of nodes in the tree, including the root */
+     size_t groupStart;            /**< index of the first step of the open group */
+     int groupDepth;               /**< number of beginHistoryGroup calls not yet committed */
+
+     char (*checkpoints)[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+                                   /**< copy of the board every 'checkpointInterval' steps:
+                                        checkpoint k is the board just before step k * interval */
+     size_t checkpointCount;       /**< number of checkpoints that match the recorded steps */
+     size_t checkpointCapacity;    /**< number of elements allocated in 'checkpoints' */
+     size_t checkpointInterval;    /**< number of steps between checkpoints */
+
+     FILE *journal;                /**< append-only record of every change, or NULL if not kept */
+     bool journalBoardPending;     /**< the board was reset, and its new contents aren't in the
+                                        journal yet (they're filled in after clearHistory) */
+     size_t journalUnsyncedCount;  /**< entries written since the journal was last synced */
+     time_t journalSyncTime;       /**< when the journal was last synced */
 
      struct SudokuBoard *owner;    /**< whose history is this? So we don't have to pass
                                         it as a parameter to any "member" functions */
@@ -35,6 +127,16 @@ struct HistoryStruct {
 typedef struct HistoryStruct HistoryStruct;
 
 
+void writeHistoryJournal(History history, char tag, const unsigned char *payload, size_t size);
+void journalHistoryPosition(History history);
+void restoreHistoryStep(History history, size_t step);
+unsigned addHistoryNode(History history, unsigned parent, HistoryRecord record);
+size_t getHistoryNodeDepth(History history, unsigned node);
+size_t getHistorySharedSteps(History history, unsigned node, size_t depth);
+void moveToHistoryNode(History history, unsigned leaf);
+size_t replayHistoryJournal(History history, const unsigned char *data, size_t length);
+
+
 /**
  * Factory function that creates and initializes a dynamic History object for a 
  * SudokuBoard. The SudokuBoard calls this function with itself as a parameter
@@ -52,18 +154,50 @@ History createHistory(struct SudokuBoard *owner)
           terminate("ERROR: could not create History");
      }
 
-     // allocate a dynamic array for holding HistorySteps
-     history->capacity = 1;
+     // allocate the first chunk for holding HistorySteps
+     history->chunkCapacity = 1;
+     history->chunkCount = 1;
      history->length = 0;
-     history->steps = malloc(sizeof(HistoryStep) * history->capacity);
+     history->chunks = malloc(sizeof(*history->chunks) * history->chunkCapacity);
+     history->pathChunks = malloc(sizeof(*history->pathChunks) * history->chunkCapacity);
 
-     if (history->steps == NULL)
+     if (history->chunks == NULL || history->pathChunks == NULL ||
+         (history->chunks[0] = malloc(sizeof(HistoryRecord) * HISTORY_CHUNK_SIZE)) == NULL ||
+         (history->pathChunks[0] = malloc(sizeof(unsigned) * HISTORY_CHUNK_SIZE)) == NULL)
      {
           terminate("ERROR: could not initialize History steps");
      }
 
+     // the tree starts out as just its root
+     history->nodeChunkCapacity = 1;
+     history->nodeChunkCount = 1;
+     history->nodeChunks = malloc(sizeof(*history->nodeChunks) * history->nodeChunkCapacity);
+
+     if (history->nodeChunks == NULL ||
+         (history->nodeChunks[0] = malloc(sizeof(HistoryNode) * HISTORY_CHUNK_SIZE)) == NULL)
+     {
+          terminate("ERROR: could not initialize History tree");
+     }
+
+     memset(&HISTORY_NODE(history, 0), 0, sizeof(HistoryNode));
+     history->nodeCount = 1;
+
      // position currentStep to be ready for recording the first history event
-     history->currentStep = history->steps;
+     history->currentStep = 0;
+     history->groupStart = 0;
+     history->groupDepth = 0;
+
+     // checkpoints are allocated as the History grows
+     history->checkpoints = NULL;
+     history->checkpointCount = 0;
+     history->checkpointCapacity = 0;
+     history->checkpointInterval = HISTORY_CHECKPOINT_INTERVAL_DEFAULT;
+
+     // no journal unless openHistoryJournal is called
+     history->journal = NULL;
+     history->journalBoardPending = false;
+     history->journalUnsyncedCount = 0;
+     history->journalSyncTime = 0;
 
      // record owner of this History stack for future undo/redo operations
      history->owner = owner;
@@ -82,9 +216,26 @@ void freeHistory(History *historyPtr)
      if (historyPtr && *historyPtr)
      {
           History history = *historyPtr;
+          size_t i;
+
+          closeHistoryJournal(history);
           
           // deallocate memory used to store all the HistorySteps
-          free(history->steps);
+          for (i = 0; i < history->chunkCount; ++i)
+          {
+               free(history->chunks[i]);
+               free(history->pathChunks[i]);
+          }
+
+          for (i = 0; i < history->nodeChunkCount; ++i)
+          {
+               free(history->nodeChunks[i]);
+          }
+
+          free(history->chunks);
+          free(history->pathChunks);
+          free(history->nodeChunks);
+          free(history->checkpoints);
 
           // deallocate the History object itself
           free(history);
@@ -99,8 +250,37 @@ void freeHistory(History *historyPtr)
 }
 
 /**
-* Reallocates a HistoryStruct's 'steps' member with a larger size if there not enough room to add
-* the specified number of HistorySteps
+* Discards every step in a HistoryStruct, leaving it empty but keeping its allocated capacity,
+* so a board can be reused for a new game without reallocating its History.
+*
+* @param history Pointer to HistoryStruct to be cleared
+*/
+void clearHistory(History history)
+{
+     if (history)
+     {
+          history->length = 0;
+          history->currentStep = 0;
+          history->groupStart = 0;
+          history->groupDepth = 0;
+          history->checkpointCount = 0;
+
+          // cut the tree back to its root; the arena's chunks are kept for reuse
+          HISTORY_NODE(history, 0).firstChild = 0;
+          history->nodeCount = 1;
+
+          // the journal has to start over from the board that replaces this one
+          history->journalBoardPending = history->journal != NULL;
+     }
+     else
+     {
+          terminate("ERROR: tried to clear a null History");
+     }
+}
+
+/**
+* Allocates more chunks for a HistoryStruct if there is not enough room to add the specified
+* number of HistorySteps. Steps already recorded stay where they are.
 * No change occurs if capacity is large enough already.
 *
 * @param history Pointer to HistoryStruct that will be modified
@@ -110,25 +290,36 @@ void growHistory(History history, size_t stepsToAdd)
 {
      if (history)
      {
-          if (history->steps)
+          if (history->chunks)
           {
-               if (stepsToAdd > (history->capacity - history->length))
+               while (history->currentStep + stepsToAdd > history->chunkCount * HISTORY_CHUNK_SIZE)
                {
-                    int currentStepIndex = history->currentStep - history->steps;
-                    history->capacity *= 2;
-                    history->steps = realloc(history->steps, sizeof(HistoryStep) * history->capacity);
+                    // only the array of chunk pointers is ever reallocated
+                    if (history->chunkCount == history->chunkCapacity)
+                    {
+                         history->chunkCapacity *= 2;
+                         history->chunks = realloc(history->chunks, sizeof(*history->chunks) * history->chunkCapacity);
+                         history->pathChunks = realloc(history->pathChunks,
+                              sizeof(*history->pathChunks) * history->chunkCapacity);
+
+                         if (history->chunks == NULL || history->pathChunks == NULL)
+                         {
+                              terminate("ERROR: unable to grow history");
+                         }
+                    }
 
-                    if (history->steps == NULL)
+                    if ((history->chunks[history->chunkCount] = malloc(sizeof(HistoryRecord) * HISTORY_CHUNK_SIZE)) == NULL ||
+                        (history->pathChunks[history->chunkCount] = malloc(sizeof(unsigned) * HISTORY_CHUNK_SIZE)) == NULL)
                     {
                          terminate("ERROR: unable to grow history");
                     }
 
-                    history->currentStep = history->steps + currentStepIndex;
+                    ++history->chunkCount;
                }
           }
           else
           {
-               terminate("ERROR: tried to grow a History with null steps array");
+               terminate("ERROR: tried to grow a History with null chunks array");
           }
      }
      else
@@ -137,6 +328,77 @@ void growHistory(History history, size_t stepsToAdd)
      }
 }
 
+/**
+* Stores a copy of a board as a checkpoint of a HistoryStruct, discarding any checkpoints after it
+*
+* @param history Pointer to HistoryStruct that will receive the checkpoint
+* @param checkpoint Index of the checkpoint to store
+* @param contents Board to copy, as it is just before step (checkpoint * checkpointInterval)
+*/
+void addHistoryCheckpoint(History history, size_t checkpoint,
+     const char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT])
+{
+     if (checkpoint >= history->checkpointCapacity)
+     {
+          history->checkpointCapacity = history->checkpointCapacity ? history->checkpointCapacity * 2 : 16;
+          history->checkpoints = realloc(history->checkpoints,
+               sizeof(*history->checkpoints) * history->checkpointCapacity);
+
+          if (history->checkpoints == NULL)
+          {
+               terminate("ERROR: unable to grow history checkpoints");
+          }
+     }
+
+     memcpy(history->checkpoints[checkpoint], contents, sizeof(*history->checkpoints));
+     history->checkpointCount = checkpoint + 1;
+}
+
+/**
+* Allocates a node from the arena of a HistoryStruct and links it in as the newest child of its
+* parent
+*
+* @param history Pointer to HistoryStruct
+* @param parent Node of the step the new one was made after (0 for the first step)
+* @param record The step, with bit 15 set if it joined its parent's group
+* @return Index of the new node
+*/
+unsigned addHistoryNode(History history, unsigned parent, HistoryRecord record)
+{
+     unsigned node = (unsigned) history->nodeCount;
+
+     if (history->nodeCount == history->nodeChunkCount * HISTORY_CHUNK_SIZE)
+     {
+          // only the array of chunk pointers is ever reallocated
+          if (history->nodeChunkCount == history->nodeChunkCapacity)
+          {
+               history->nodeChunkCapacity *= 2;
+               history->nodeChunks = realloc(history->nodeChunks,
+                    sizeof(*history->nodeChunks) * history->nodeChunkCapacity);
+
+               if (history->nodeChunks == NULL)
+               {
+                    terminate("ERROR: unable to grow history tree");
+               }
+          }
+
+          if ((history->nodeChunks[history->nodeChunkCount++] = malloc(sizeof(HistoryNode) * HISTORY_CHUNK_SIZE)) == NULL)
+          {
+               terminate("ERROR: unable to grow history tree");
+          }
+     }
+
+     HISTORY_NODE(history, node).parent = parent;
+     HISTORY_NODE(history, node).firstChild = 0;
+     HISTORY_NODE(history, node).nextSibling = HISTORY_NODE(history, parent).firstChild;
+     HISTORY_NODE(history, node).record = record;
+     HISTORY_NODE(history, parent).firstChild = node;
+
+     ++history->nodeCount;
+
+     return node;
+}
+
 /**
 * Add a HistoryStep to a HistoryStruct stack
 *
@@ -152,11 +414,52 @@ void addUndoStep(History history, Coord2D *square, int value)
           {
                if (validateSudokuDigit(value))
                {
+                    bool joinsGroup = history->groupDepth > 0 && history->currentStep > history->groupStart;
+
+                    // join the step below, if both are part of the open group. The step below may still
+                    // be marked from an old group that 'goto' stopped in the middle of
+                    if (history->currentStep > 0)
+                    {
+                         if (joinsGroup)
+                         {
+                              HISTORY_RECORD_AT(history, history->currentStep - 1) |= HISTORY_RECORD_CONTINUED;
+                         }
+                         else
+                         {
+                              HISTORY_RECORD_AT(history, history->currentStep - 1) &= ~HISTORY_RECORD_CONTINUED;
+                         }
+                    }
+
+                    // take a checkpoint of the board as it is before this step, if one is due. Otherwise,
+                    // checkpoints above this step were taken on the steps it replaces, so drop them
+                    if (history->currentStep % history->checkpointInterval == 0)
+                    {
+                         addHistoryCheckpoint(history, HISTORY_CHECKPOINT_AT_STEP(history, history->currentStep),
+                              history->owner->contents);
+                    }
+                    else if (history->checkpointCount > HISTORY_CHECKPOINT_AT_STEP(history, history->currentStep) + 1)
+                    {
+                         history->checkpointCount = HISTORY_CHECKPOINT_AT_STEP(history, history->currentStep) + 1;
+                    }
+
                     // store location and current value of sudoku square
-                    history->currentStep->location = *square;
-                    history->currentStep->newValue = value;
-                    history->currentStep->oldValue =
-                         history->owner->contents[square->row][square->col];
+                    HISTORY_RECORD_AT(history, history->currentStep) = HISTORY_RECORD_PACK(square->row, square->col,
+                         value, history->owner->contents[square->row][square->col]);
+
+                    if (history->journal)
+                    {
+                         HistoryRecord record = HISTORY_RECORD_AT(history, history->currentStep) & ~HISTORY_RECORD_CONTINUED;
+                         unsigned char payload[2];
+
+                         payload[0] = (unsigned char) record;
+                         payload[1] = (unsigned char) (record >> 8);
+                         writeHistoryJournal(history, HISTORY_JOURNAL_STEP, payload, sizeof(payload));
+                    }
+
+                    // the step also becomes a new branch of the tree, alongside any steps that were undone
+                    HISTORY_PATH_NODE_AT(history, history->currentStep) = addHistoryNode(history,
+                         history->currentStep ? HISTORY_PATH_NODE_AT(history, history->currentStep - 1) : 0,
+                         HISTORY_RECORD_AT(history, history->currentStep) | (joinsGroup ? HISTORY_RECORD_CONTINUED : 0));
 
                     // advance history
                     ++history->currentStep;
@@ -179,6 +482,76 @@ void addUndoStep(History history, Coord2D *square, int value)
      }
 }
 
+/**
+* Starts a group of steps that will be undone and redone as a single step, e.g. all the changes
+* made by one 'solve' command. Groups may be nested; only the outermost one counts.
+*
+* @param history Pointer to HistoryStruct
+*/
+void beginHistoryGroup(History history)
+{
+     if (history)
+     {
+          if (history->groupDepth++ == 0)
+          {
+               history->groupStart = history->currentStep;
+          }
+
+          writeHistoryJournal(history, HISTORY_JOURNAL_BEGIN_GROUP, NULL, 0);
+     }
+     else
+     {
+          terminate("ERROR: tried to begin a group in a null History");
+     }
+}
+
+/**
+* Ends the group of steps started by the matching call to beginHistoryGroup
+*
+* @param history Pointer to HistoryStruct
+*/
+void commitHistoryGroup(History history)
+{
+     if (history)
+     {
+          if (history->groupDepth > 0)
+          {
+               --history->groupDepth;
+          }
+
+          writeHistoryJournal(history, HISTORY_JOURNAL_COMMIT_GROUP, NULL, 0);
+     }
+     else
+     {
+          terminate("ERROR: tried to commit a group in a null History");
+     }
+}
+
+/**
+* Writes the 'old' or 'new' values of a run of steps straight into the board, then brings the
+* board's digit flags up to date once at the end. Much faster than setting one square at a time
+* when the run is long.
+*
+* @param history Pointer to HistoryStruct
+* @param first Index of the first step of the run
+* @param count Number of steps in the run
+* @param restoreOldValues True to undo the run (applied newest first), false to redo it
+*/
+void applyHistoryRun(History history, size_t first, size_t count, bool restoreOldValues)
+{
+     HistoryRecord record;
+     size_t i;
+
+     for (i = 0; i < count; ++i)
+     {
+          record = HISTORY_RECORD_AT(history, restoreOldValues ? first + count - 1 - i : first + i);
+          history->owner->contents[HISTORY_RECORD_ROW(record)][HISTORY_RECORD_COLUMN(record)] =
+               restoreOldValues ? HISTORY_RECORD_OLD_VALUE(record) : HISTORY_RECORD_NEW_VALUE(record);
+     }
+
+     refreshSudokuBoardDigits(history->owner);
+}
+
 /**
 * Roll back the changes associated with the most recent HistoryStep(s) in a HistoryStruct
 * Automatically recognizes if bottom of the history stack is reached.
@@ -193,49 +566,63 @@ bool undoStep(History history, size_t stepsToUndo)
 
      if (history)
      {
-          if (history->currentStep)
+          // only take action if the number of steps is not 0
+          if (stepsToUndo)
           {
-               // only take action if the number of steps is not 0
-               if (stepsToUndo)
+               // if currentStep is the bottom of the stack, there are no steps to undo
+               if (history->currentStep == 0)
                {
-                    // if currentStep is the bottom of the stack, there are no steps to undo
-                    if (history->currentStep == history->steps)
+                    puts("<no steps to undo>");
+                    status = false;
+               }
+               else
+               {
+                    HistoryRecord record;
+                    size_t i, existingValue;
+
+                    printf("Undoing %d steps:\n", stepsToUndo);
+
+                    for (i = 0; i < stepsToUndo && history->currentStep != 0; ++i)
                     {
-                         puts("<no steps to undo>");
-                         status = false;
-                    }
-                    else
-                    {                        
-                         Coord2D *currentSquare = &(history->currentStep - 1)->location;
-                         size_t i, existingValue;
+                         size_t groupEnd = history->currentStep;
 
-                         printf("Undoing %d steps:\n", stepsToUndo);
+                         // walk down to the first step of the group, if the top step is part of one
+                         --history->currentStep;
 
-                         for (i = 0; i < stepsToUndo && history->currentStep != history->steps; ++i)
+                         while (history->currentStep > 0 &&
+                                (HISTORY_RECORD_AT(history, history->currentStep - 1) & HISTORY_RECORD_CONTINUED))
                          {
                               --history->currentStep;
-                              currentSquare = &history->currentStep->location;
-                              existingValue = history->owner->contents[currentSquare->row][currentSquare->col];
-                              history->owner->contents[currentSquare->row][currentSquare->col] =
-                                   history->currentStep->oldValue;
-
-                              printf("   %d: changed %c%d from %d back to %d\n", i + 1,
-                                   colLabels[currentSquare->col], currentSquare->row + 1,
-                                   existingValue, history->currentStep->oldValue);
                          }
 
-                         // if function was asked to undo more steps than were available
-                         if (i < stepsToUndo)
+                         if (groupEnd - history->currentStep > 1)
                          {
-                              puts("<no more steps to undo>");
+                              applyHistoryRun(history, history->currentStep, groupEnd - history->currentStep, true);
+
+                              printf("   %lu: changed %lu squares back as a group\n", (unsigned long) i + 1,
+                                   (unsigned long) (groupEnd - history->currentStep));
+                              continue;
                          }
+
+                         record = HISTORY_RECORD_AT(history, history->currentStep);
+                         existingValue = history->owner->contents[HISTORY_RECORD_ROW(record)][HISTORY_RECORD_COLUMN(record)];
+                         setSudokuSquare(history->owner, HISTORY_RECORD_ROW(record), HISTORY_RECORD_COLUMN(record),
+                              HISTORY_RECORD_OLD_VALUE(record));
+
+                         printf("   %d: changed %c%d from %d back to %d\n", i + 1,
+                              colLabels[HISTORY_RECORD_COLUMN(record)], HISTORY_RECORD_ROW(record) + 1,
+                              existingValue, HISTORY_RECORD_OLD_VALUE(record));
+                    }
+
+                    journalHistoryPosition(history);
+
+                    // if function was asked to undo more steps than were available
+                    if (i < stepsToUndo)
+                    {
+                         puts("<no more steps to undo>");
                     }
                }
           }
-          else
-          {
-               terminate("ERROR: can't restore undo step if currentStep is null");
-          }
      }
      else
      {
@@ -259,67 +646,767 @@ bool redoStep(History history, size_t stepsToRedo)
 
      if (history)
      {
-          if (history->currentStep)
+          // only take action if the number of steps is not 0
+          if (stepsToRedo)
           {
-               // only take action if the number of steps is not 0
-               if (stepsToRedo)
+               // if currentStep is the top of the stack, there are no steps to redo
+               if (history->currentStep == history->length)
                {
-                    // if currentStep is the top of the stack, there are no steps to redo
-                    if (history->currentStep == history->steps + history->length)
-                    {
-                         puts("<no steps to redo>");
-                         status = false;
-                    }
-                    else
-                    {
-                         Coord2D *currentSquare = &(history->currentStep - 1)->location;
-                         size_t i, existingValue;
-
-                         printf("Redoing %d steps:\n", stepsToRedo);
+                    puts("<no steps to redo>");
+                    status = false;
+               }
+               else
+               {
+                    HistoryRecord record;
+                    size_t i, existingValue;
 
-                         for (i = 0; i < stepsToRedo && history->currentStep != history->steps + history->length; ++i)
-                         {
-                              currentSquare = &history->currentStep->location;
-                              existingValue = history->owner->contents[currentSquare->row][currentSquare->col];
-                              history->owner->contents[currentSquare->row][currentSquare->col] =
-                                   history->currentStep->newValue;
+                    printf("Redoing %d steps:\n", stepsToRedo);
 
-                              printf("   %d: changed %c%d from %d back to %d\n", i + 1,
-                                   colLabels[currentSquare->col], currentSquare->row + 1,
-                                   existingValue, history->currentStep->newValue);
+                    for (i = 0; i < stepsToRedo && history->currentStep != history->length; ++i)
+                    {
+                         size_t groupStart = history->currentStep, groupEnd = history->currentStep + 1;
 
-                              ++history->currentStep;
+                         // walk up to the last step of the group, if this step is part of one
+                         while (groupEnd < history->length &&
+                                (HISTORY_RECORD_AT(history, groupEnd - 1) & HISTORY_RECORD_CONTINUED))
+                         {
+                              ++groupEnd;
                          }
 
-                         // if function was asked to undo more steps than were available
-                         if (i < stepsToRedo)
+                         if (groupEnd - groupStart > 1)
                          {
-                              puts("<no more steps to redo>");
+                              applyHistoryRun(history, groupStart, groupEnd - groupStart, false);
+                              history->currentStep = groupEnd;
+
+                              printf("   %lu: changed %lu squares again as a group\n", (unsigned long) i + 1,
+                                   (unsigned long) (groupEnd - groupStart));
+                              continue;
                          }
+
+                         record = HISTORY_RECORD_AT(history, history->currentStep);
+                         existingValue = history->owner->contents[HISTORY_RECORD_ROW(record)][HISTORY_RECORD_COLUMN(record)];
+                         setSudokuSquare(history->owner, HISTORY_RECORD_ROW(record), HISTORY_RECORD_COLUMN(record),
+                              HISTORY_RECORD_NEW_VALUE(record));
+
+                         printf("   %d: changed %c%d from %d back to %d\n", i + 1,
+                              colLabels[HISTORY_RECORD_COLUMN(record)], HISTORY_RECORD_ROW(record) + 1,
+                              existingValue, HISTORY_RECORD_NEW_VALUE(record));
+
+                         ++history->currentStep;
+                    }
+
+                    journalHistoryPosition(history);
+
+                    // if function was asked to undo more steps than were available
+                    if (i < stepsToRedo)
+                    {
+                         puts("<no more steps to redo>");
                     }
                }
           }
-          else
+     }
+     else
+     {
+          terminate("ERROR: tried to restore undo step from a null History");
+     }
+
+     return status;
+}
+
+/**
+* Writes the board's contents as they were after a given step, without updating its digit flags.
+*
+* @param history Pointer to HistoryStruct, with at least one step
+* @param step Number of steps from the bottom of the history to apply, from 0 to the length
+*/
+void restoreHistoryStep(History history, size_t step)
+{
+     size_t checkpoint = HISTORY_CHECKPOINT_AT_STEP(history, step);
+     size_t i;
+
+     // the checkpoint at the very top of history isn't taken until a step is added on top
+     if (checkpoint >= history->checkpointCount)
+     {
+          checkpoint = history->checkpointCount - 1;
+     }
+
+     memcpy(history->owner->contents, history->checkpoints[checkpoint], sizeof(*history->checkpoints));
+
+     for (i = checkpoint * history->checkpointInterval; i < step; ++i)
+     {
+          HistoryRecord record = HISTORY_RECORD_AT(history, i);
+
+          history->owner->contents[HISTORY_RECORD_ROW(record)][HISTORY_RECORD_COLUMN(record)] =
+               HISTORY_RECORD_NEW_VALUE(record);
+     }
+
+     history->currentStep = step;
+}
+
+/**
+* Puts the board back the way it was after a given number of steps, by copying the nearest
+* checkpoint at or below that step and replaying at most one interval's worth of steps from it.
+* Steps on either side stay in history, so 'undo', 'redo' and 'goto' keep working afterwards.
+*
+* @param history Pointer to HistoryStruct
+* @param step Number of steps from the bottom of the history to apply, from 0 to the length
+* @return True if the board was moved to the step, false if the step is out of range
+*/
+bool gotoHistoryStep(History history, size_t step)
+{
+     bool status = true;
+
+     if (history)
+     {
+          if (step > history->length)
           {
-               terminate("ERROR: can't restore undo step if currentStep is null");
+               printf("<step must be from 0 to %lu>\n", (unsigned long) history->length);
+               status = false;
+          }
+          else if (history->length && step != history->currentStep)
+          {
+               restoreHistoryStep(history, step);
+               refreshSudokuBoardDigits(history->owner);
+               journalHistoryPosition(history);
           }
      }
      else
      {
-          terminate("ERROR: tried to restore undo step from a null History");
+          terminate("ERROR: tried to go to a step in a null History");
      }
 
      return status;
 }
 
 /**
-* If there are any HistorySteps PAST the current history location (i.e. steps that could be redone),
-* make them inaccessible, because they are no longer valid.
+* Changes how many steps apart the checkpoints of a HistoryStruct are, rebuilding the checkpoints
+* already taken. Shorter intervals make 'goto' faster at the cost of 81 bytes per checkpoint.
 *
 * @param history Pointer to HistoryStruct
+* @param interval Number of steps between checkpoints, at least 1
 */
-void invalidateSubsequentRedoSteps(History history)
+void setHistoryCheckpointInterval(History history, size_t interval)
 {
-     // set current state of board as final available redo step
-     history->length = history->currentStep - history->steps;
+     if (history && interval)
+     {
+          if (interval != history->checkpointInterval)
+          {
+               char contents[SUDOKU_ROW_COUNT][SUDOKU_COL_COUNT];
+               size_t i;
+
+               // replay every step from the board before the first one, which is always checkpoint 0
+               if (history->checkpointCount)
+               {
+                    memcpy(contents, history->checkpoints[0], sizeof(contents));
+               }
+
+               history->checkpointInterval = interval;
+               history->checkpointCount = 0;
+
+               for (i = 0; i < history->length; ++i)
+               {
+                    HistoryRecord record = HISTORY_RECORD_AT(history, i);
+
+                    if (i % interval == 0)
+                    {
+                         addHistoryCheckpoint(history, HISTORY_CHECKPOINT_AT_STEP(history, i), contents);
+                    }
+
+                    contents[HISTORY_RECORD_ROW(record)][HISTORY_RECORD_COLUMN(record)] = HISTORY_RECORD_NEW_VALUE(record);
+               }
+          }
+     }
+     else
+     {
+          terminate("ERROR: tried to set checkpoint interval of a null History, or to 0");
+     }
+}
+
+/**
+* Reports where a HistoryStruct is and how it is checkpointed
+*
+* @param history Pointer to HistoryStruct
+* @param currentStep Receives the number of steps currently applied to the board
+* @param length Receives the number of steps in history, including ones that could be redone
+* @param checkpointCount Receives the number of checkpoints taken
+* @param checkpointInterval Receives the number of steps between checkpoints
+*/
+void getHistoryPosition(History history, size_t *currentStep, size_t *length, size_t *checkpointCount,
+     size_t *checkpointInterval)
+{
+     if (history)
+     {
+          *currentStep = history->currentStep;
+          *length = history->length;
+          *checkpointCount = history->checkpointCount;
+          *checkpointInterval = history->checkpointInterval;
+     }
+     else
+     {
+          terminate("ERROR: tried to get position of a null History");
+     }
+}
+
+/**
+* Counts the steps from the root of the tree down to a node
+*
+* @param history Pointer to HistoryStruct
+* @param node Index of the node
+* @return Number of steps on the branch that ends at the node
+*/
+size_t getHistoryNodeDepth(History history, unsigned node)
+{
+     size_t depth = 0;
+
+     for (; node != 0; node = HISTORY_NODE(history, node).parent)
+     {
+          ++depth;
+     }
+
+     return depth;
+}
+
+/**
+* Counts how many steps the branch ending at a node has in common with the current branch
+*
+* @param history Pointer to HistoryStruct
+* @param node Index of the node
+* @param depth Depth of the node (see getHistoryNodeDepth)
+* @return Number of steps, from the root, that both branches share
+*/
+size_t getHistorySharedSteps(History history, unsigned node, size_t depth)
+{
+     // walk up until reaching a node that the current branch passes through
+     while (node != 0 && !(depth <= history->length && HISTORY_PATH_NODE_AT(history, depth - 1) == node))
+     {
+          node = HISTORY_NODE(history, node).parent;
+          --depth;
+     }
+
+     return depth;
+}
+
+/**
+* Makes the branch ending at a node the current branch, and moves the board to its last step.
+* The board is restored at the step where the branches part, then the new branch's steps are
+* replayed from there, re-taking the checkpoints they pass.
+*
+* @param history Pointer to HistoryStruct
+* @param leaf Index of the node at the end of the branch
+*/
+void moveToHistoryNode(History history, unsigned leaf)
+{
+     size_t depth = getHistoryNodeDepth(history, leaf);
+     size_t shared = getHistorySharedSteps(history, leaf, depth);
+     size_t i;
+     unsigned node;
+
+     // put the board where both branches agree, while the old branch's checkpoints still apply
+     if (history->nodeCount > 1)
+     {
+          restoreHistoryStep(history, shared);
+     }
+
+     if (history->checkpointCount > HISTORY_CHECKPOINT_AT_STEP(history, shared) + 1)
+     {
+          history->checkpointCount = HISTORY_CHECKPOINT_AT_STEP(history, shared) + 1;
+     }
+
+     history->currentStep = shared;
+     growHistory(history, depth - shared);
+
+     // copy the new branch's nodes and records in, from the bottom up
+     for (i = depth, node = leaf; i > shared; --i, node = HISTORY_NODE(history, node).parent)
+     {
+          HISTORY_PATH_NODE_AT(history, i - 1) = node;
+     }
+
+     // a record on the branch carries the group bit of the step above it (see HistoryRecord)
+     for (i = shared ? shared - 1 : 0; i < depth; ++i)
+     {
+          HistoryRecord record = HISTORY_NODE(history, HISTORY_PATH_NODE_AT(history, i)).record & ~HISTORY_RECORD_CONTINUED;
+
+          if (i + 1 < depth)
+          {
+               record |= HISTORY_NODE(history, HISTORY_PATH_NODE_AT(history, i + 1)).record & HISTORY_RECORD_CONTINUED;
+          }
+
+          HISTORY_RECORD_AT(history, i) = record;
+     }
+
+     for (i = shared; i < depth; ++i)
+     {
+          HistoryRecord record = HISTORY_RECORD_AT(history, i);
+
+          if (i % history->checkpointInterval == 0)
+          {
+               addHistoryCheckpoint(history, HISTORY_CHECKPOINT_AT_STEP(history, i), history->owner->contents);
+          }
+
+          history->owner->contents[HISTORY_RECORD_ROW(record)][HISTORY_RECORD_COLUMN(record)] =
+               HISTORY_RECORD_NEW_VALUE(record);
+     }
+
+     history->currentStep = depth;
+     history->length = depth;
+}
+
+/**
+* Lists every branch of the tree of steps: one for each step that nothing was done after.
+* Branches are numbered in the order their last step was made.
+*
+* @param history Pointer to HistoryStruct
+* @return Number of branches
+*/
+size_t listHistoryBranches(History history)
+{
+     size_t branchCount = 0;
+     unsigned node;
+
+     if (history)
+     {
+          unsigned currentLeaf = history->length ? HISTORY_PATH_NODE_AT(history, history->length - 1) : 0;
+
+          for (node = 1; node < history->nodeCount; ++node)
+          {
+               if (HISTORY_NODE(history, node).firstChild == 0)
+               {
+                    size_t depth = getHistoryNodeDepth(history, node);
+                    HistoryRecord record = HISTORY_NODE(history, node).record;
+
+                    printf("%c %lu: %lu steps, ending with %c%d set to %d", node == currentLeaf ? '*' : ' ',
+                         (unsigned long) ++branchCount, (unsigned long) depth, colLabels[HISTORY_RECORD_COLUMN(record)],
+                         HISTORY_RECORD_ROW(record) + 1, HISTORY_RECORD_NEW_VALUE(record));
+
+                    if (node != currentLeaf)
+                    {
+                         printf(" (shares the first %lu with this branch)",
+                              (unsigned long) getHistorySharedSteps(history, node, depth));
+                    }
+
+                    putchar('\n');
+               }
+          }
+
+          if (branchCount == 0)
+          {
+               puts("<no steps in history>");
+          }
+          else
+          {
+               printf("%lu steps in %lu branches, using %lu bytes\n", (unsigned long) history->nodeCount - 1,
+                    (unsigned long) branchCount, (unsigned long) (history->nodeCount * sizeof(HistoryNode)));
+          }
+     }
+     else
+     {
+          terminate("ERROR: tried to list branches of a null History");
+     }
+
+     return branchCount;
+}
+
+/**
+* Makes one of the branches listed by listHistoryBranches the current branch, moving the board
+* to its last step. Nothing is lost: the branch that was current can be switched back to.
+*
+* @param history Pointer to HistoryStruct
+* @param branch Number of the branch, as listed by listHistoryBranches (starting from 1)
+* @return False if there is no such branch
+*/
+bool switchHistoryBranch(History history, size_t branch)
+{
+     bool status = false;
+     unsigned node;
+
+     if (history)
+     {
+          // find the branch's last step, counting leaves the same way listHistoryBranches does
+          for (node = 1; !status && node < history->nodeCount; ++node)
+          {
+               if (HISTORY_NODE(history, node).firstChild == 0 && --branch == 0)
+               {
+                    unsigned char payload[4];
+
+                    moveToHistoryNode(history, node);
+                    refreshSudokuBoardDigits(history->owner);
+
+                    payload[0] = (unsigned char) node;
+                    payload[1] = (unsigned char) (node >> 8);
+                    payload[2] = (unsigned char) (node >> 16);
+                    payload[3] = (unsigned char) (node >> 24);
+                    writeHistoryJournal(history, HISTORY_JOURNAL_BRANCH, payload, sizeof(payload));
+
+                    status = true;
+               }
+          }
+
+          if (!status)
+          {
+               puts("<no such branch>");
+          }
+     }
+     else
+     {
+          terminate("ERROR: tried to switch branches of a null History");
+     }
+
+     return status;
+}
+
+/**
+* Steps PAST the current history location (i.e. steps that could be redone) are taken off the
+* current branch, since a new step is being made instead. They stay in the tree as a branch of
+* their own, which switchHistoryBranch can return to.
+*
+* @param history Pointer to HistoryStruct
+*/
+void invalidateSubsequentRedoSteps(History history)
+{
+     // set current state of board as final available redo step
+     history->length = history->currentStep;
+
+     writeHistoryJournal(history, HISTORY_JOURNAL_TRUNCATE, NULL, 0);
+
+     // a checkpoint above the new top may describe a board that will never exist
+     if (history->checkpointCount > HISTORY_CHECKPOINT_AT_STEP(history, history->length) + 1)
+     {
+          history->checkpointCount = HISTORY_CHECKPOINT_AT_STEP(history, history->length) + 1;
+     }
+}
+
+/**
+* Starts keeping a journal of every change to a HistoryStruct in a file, so the session survives
+* the program exiting or crashing. If the file already holds a journal, the board and its whole
+* history are first rebuilt from it; new entries are then appended after the old ones. An entry
+* cut off part-way (e.g. by a crash while it was being written) is thrown away.
+*
+* @param history Pointer to HistoryStruct, belonging to a freshly-initialized board
+* @param fileName Name of the journal file, created if it doesn't exist
+* @param restored Set to true if a board was rebuilt from the journal
+* @return False if the file couldn't be used as a journal
+*/
+bool openHistoryJournal(History history, const char *fileName, bool *restored)
+{
+     SudokuPuzzleFile file;
+     size_t validLength = 0;
+     bool status = true;
+
+     *restored = false;
+
+     if (history == NULL)
+     {
+          terminate("ERROR: tried to open a journal for a null History");
+     }
+
+     // an existing journal is mapped into memory and replayed straight out of the mapping
+     if (openSudokuPuzzleFile(&file, fileName) && file.length > 0)
+     {
+          if (file.length >= HISTORY_JOURNAL_HEADER_SIZE &&
+              memcmp(file.data, HISTORY_JOURNAL_MAGIC, 4) == 0 &&
+              (unsigned char) file.data[4] == HISTORY_JOURNAL_VERSION)
+          {
+               validLength = replayHistoryJournal(history, (const unsigned char*) file.data, file.length);
+               *restored = validLength > HISTORY_JOURNAL_HEADER_SIZE;
+
+               printf("Restored %lu steps from journal \"%s\"", (unsigned long) history->length, fileName);
+
+               if (validLength < file.length)
+               {
+                    printf(" (discarded %lu bytes of an unfinished entry)", (unsigned long) (file.length - validLength));
+               }
+
+               putchar('\n');
+          }
+          else
+          {
+               printf("Sorry, \"%s\" is not a history journal\n", fileName);
+               status = false;
+          }
+     }
+
+     closeSudokuPuzzleFile(&file);
+
+     if (status)
+     {
+          // reopen for writing, chopping off anything after the last complete entry
+          if (validLength > 0)
+          {
+               // entries collect in a large buffer; syncHistoryJournal writes them out in batches.
+               // (the buffer has to be set before anything else is done with the file)
+               if ((history->journal = fopen(fileName, "r+b")) &&
+                   (setvbuf(history->journal, NULL, _IOFBF, HISTORY_JOURNAL_BUFFER_SIZE) != 0 ||
+#ifdef _WIN32
+                   _chsize_s(_fileno(history->journal), (long long) validLength) != 0 ||
+#else
+                   ftruncate(fileno(history->journal), (off_t) validLength) != 0 ||
+#endif
+                   fseek(history->journal, 0, SEEK_END) != 0))
+               {
+                    fclose(history->journal);
+                    history->journal = NULL;
+               }
+          }
+          else if ((history->journal = fopen(fileName, "wb")) != NULL)
+          {
+               unsigned char header[HISTORY_JOURNAL_HEADER_SIZE] = { 0 };
+
+               setvbuf(history->journal, NULL, _IOFBF, HISTORY_JOURNAL_BUFFER_SIZE);
+
+               memcpy(header, HISTORY_JOURNAL_MAGIC, 4);
+               header[4] = HISTORY_JOURNAL_VERSION;
+               fwrite(header, 1, sizeof(header), history->journal);
+               ++history->journalUnsyncedCount;
+          }
+
+          if (history->journal)
+          {
+               history->journalSyncTime = time(NULL);
+
+               // the board as it is now is where a fresh journal starts
+               history->journalBoardPending = !*restored;
+          }
+          else
+          {
+               printf("Sorry, journal \"%s\" could not be opened for writing\n", fileName);
+               status = false;
+          }
+     }
+
+     // a journal cut off in the middle of a group (e.g. a crash during 'solve') leaves it open,
+     // and every later step would join it; close it, writing the missing commit if we can
+     while (history->groupDepth > 0)
+     {
+          commitHistoryGroup(history);
+     }
+
+     return status;
+}
+
+/**
+* Makes sure every journal entry written so far is safely on disk. Entries are only buffered
+* as they are written, so calling this once after each command costs at most one flush and one
+* fsync no matter how many steps the command made. Unless forced, the sync waits until
+* HISTORY_JOURNAL_SYNC_ENTRIES entries have piled up or HISTORY_JOURNAL_SYNC_SECONDS have passed,
+* so a script running thousands of commands only syncs a few times a second.
+*
+* @param history Pointer to HistoryStruct; nothing happens if it isn't keeping a journal
+* @param isForced True to sync whatever has been written, however little
+*/
+void syncHistoryJournal(History history, bool isForced)
+{
+     if (history && history->journal)
+     {
+          // a new board with no changes made to it yet must still be restored
+          if (history->journalBoardPending)
+          {
+               writeHistoryJournal(history, HISTORY_JOURNAL_BOARD, NULL, 0);
+          }
+
+          if (history->journalUnsyncedCount > 0 && (isForced ||
+              history->journalUnsyncedCount >= HISTORY_JOURNAL_SYNC_ENTRIES ||
+              difftime(time(NULL), history->journalSyncTime) >= HISTORY_JOURNAL_SYNC_SECONDS))
+          {
+               fflush(history->journal);
+#ifdef _WIN32
+               _commit(_fileno(history->journal));
+#else
+               fsync(fileno(history->journal));
+#endif
+               history->journalUnsyncedCount = 0;
+               history->journalSyncTime = time(NULL);
+          }
+     }
+}
+
+/**
+* Syncs and closes the journal of a HistoryStruct, if it has one
+*
+* @param history Pointer to HistoryStruct
+*/
+void closeHistoryJournal(History history)
+{
+     if (history && history->journal)
+     {
+          syncHistoryJournal(history, true);
+          fclose(history->journal);
+          history->journal = NULL;
+     }
+}
+
+/**
+* Appends one entry to the journal of a HistoryStruct, if it has one. Writes the board first, if
+* it was reset since the last entry.
+*
+* @param history Pointer to HistoryStruct
+* @param tag Type of entry (HISTORY_JOURNAL_...)
+* @param payload Bytes that follow the tag, or NULL if there are none
+* @param size Number of bytes in payload
+*/
+void writeHistoryJournal(History history, char tag, const unsigned char *payload, size_t size)
+{
+     if (history->journal)
+     {
+          if (history->journalBoardPending)
+          {
+               history->journalBoardPending = false;
+               fputc(HISTORY_JOURNAL_BOARD, history->journal);
+               fwrite(history->owner->contents, 1, sizeof(history->owner->contents), history->journal);
+          }
+
+          // the board itself is written above, so a board entry has nothing more to add
+          if (tag != HISTORY_JOURNAL_BOARD)
+          {
+               fputc(tag, history->journal);
+
+               // tag-only entries (group markers, truncation) have no payload to write
+               if (size > 0)
+               {
+                    fwrite(payload, 1, size, history->journal);
+               }
+          }
+
+          ++history->journalUnsyncedCount;
+     }
+}
+
+/**
+* Journals where the board now sits in its history, after undo, redo or goto
+*
+* @param history Pointer to HistoryStruct
+*/
+void journalHistoryPosition(History history)
+{
+     unsigned char payload[4];
+
+     payload[0] = (unsigned char) history->currentStep;
+     payload[1] = (unsigned char) (history->currentStep >> 8);
+     payload[2] = (unsigned char) (history->currentStep >> 16);
+     payload[3] = (unsigned char) (history->currentStep >> 24);
+
+     writeHistoryJournal(history, HISTORY_JOURNAL_POSITION, payload, sizeof(payload));
+}
+
+/**
+* Rebuilds a board and its history from the entries of a journal. Squares are written straight
+* into the board and undo/redo/goto become a single restoreHistoryStep, so the digit flags are
+* only worked out once, at the end. A group the journal never committed is left open.
+*
+* @param history Pointer to HistoryStruct, which must not be keeping a journal yet
+* @param data Contents of the journal file, starting with its header
+* @param length Number of bytes in data
+* @return Number of bytes of data that were complete, valid entries
+*/
+size_t replayHistoryJournal(History history, const unsigned char *data, size_t length)
+{
+     char (*contents)[SUDOKU_COL_COUNT] = history->owner->contents;
+     size_t position = HISTORY_JOURNAL_HEADER_SIZE;
+     bool valid = true;
+
+     while (valid && position < length)
+     {
+          const unsigned char *entry = data + position;
+          size_t entrySize = 1;
+
+          switch (entry[0])
+          {
+          case HISTORY_JOURNAL_BOARD:
+               entrySize += SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT;
+               break;
+          case HISTORY_JOURNAL_STEP:
+               entrySize += 2;
+               break;
+          case HISTORY_JOURNAL_POSITION:
+          case HISTORY_JOURNAL_BRANCH:
+               entrySize += 4;
+               break;
+          case HISTORY_JOURNAL_TRUNCATE:
+          case HISTORY_JOURNAL_BEGIN_GROUP:
+          case HISTORY_JOURNAL_COMMIT_GROUP:
+               break;
+          default:
+               valid = false;
+          }
+
+          valid = valid && position + entrySize <= length;
+
+          if (valid)
+          {
+               if (entry[0] == HISTORY_JOURNAL_BOARD)
+               {
+                    int i;
+
+                    for (i = 0; i < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT; ++i)
+                    {
+                         valid &= entry[1 + i] <= SUDOKU_DIGIT_MAX;
+                    }
+
+                    if (valid)
+                    {
+                         clearHistory(history);
+                         memcpy(contents, entry + 1, SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT);
+                    }
+               }
+               else if (entry[0] == HISTORY_JOURNAL_STEP)
+               {
+                    HistoryRecord record = (HistoryRecord) (entry[1] | (entry[2] << 8));
+                    Coord2D square;
+
+                    square.row = HISTORY_RECORD_ROW(record);
+                    square.col = HISTORY_RECORD_COLUMN(record);
+
+                    valid = (record & 0x7F) < SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT &&
+                         HISTORY_RECORD_NEW_VALUE(record) <= SUDOKU_DIGIT_MAX;
+
+                    if (valid)
+                    {
+                         addUndoStep(history, &square, HISTORY_RECORD_NEW_VALUE(record));
+                         contents[square.row][square.col] = HISTORY_RECORD_NEW_VALUE(record);
+                    }
+               }
+               else if (entry[0] == HISTORY_JOURNAL_POSITION)
+               {
+                    size_t step = entry[1] | (entry[2] << 8) | (entry[3] << 16) | ((size_t) entry[4] << 24);
+
+                    valid = step <= history->length && (step == history->currentStep || history->length > 0);
+
+                    if (valid && step != history->currentStep)
+                    {
+                         restoreHistoryStep(history, step);
+                    }
+               }
+               else if (entry[0] == HISTORY_JOURNAL_BRANCH)
+               {
+                    size_t node = entry[1] | (entry[2] << 8) | (entry[3] << 16) | ((size_t) entry[4] << 24);
+
+                    valid = node > 0 && node < history->nodeCount;
+
+                    if (valid)
+                    {
+                         moveToHistoryNode(history, (unsigned) node);
+                    }
+               }
+               else if (entry[0] == HISTORY_JOURNAL_TRUNCATE)
+               {
+                    invalidateSubsequentRedoSteps(history);
+               }
+               else if (entry[0] == HISTORY_JOURNAL_BEGIN_GROUP)
+               {
+                    beginHistoryGroup(history);
+               }
+               else
+               {
+                    commitHistoryGroup(history);
+               }
+          }
+
+          if (valid)
+          {
+               position += entrySize;
+          }
+     }
+
+     refreshSudokuBoardDigits(history->owner);
+
+     return position;
 }
@@ -20,6 +20,42 @@ struct HistoryStep {
 typedef struct HistoryStep HistoryStep;
 
 
+/*
+ * ======= HISTORY JOURNAL FORMAT =======
+ * An append-only binary file recording every change to a board's History, so a session can be
+ * rebuilt after the program exits or crashes.
+ *
+ * Header (8 bytes): magic number "SDKJ", format version (currently 1), 3 reserved bytes of 0
+ *
+ * Entries follow the header, each one a tag byte and a payload (integers little-endian):
+ *   'N' + 81 bytes: a new board; history is cleared and the board holds these squares
+ *   'S' + 2 bytes:  a step was added, packed the same way as in memory (square, new, old value)
+ *   'P' + 4 bytes:  undo, redo or goto left the board at this step
+ *   'T':            steps above the current one were taken off the current branch
+ *   'R' + 4 bytes:  the branch ending at this node of the tree became the current branch
+ *   'B' / 'C':      a group of steps began / was committed
+ */
+#define HISTORY_JOURNAL_MAGIC "SDKJ"
+#define HISTORY_JOURNAL_VERSION 1
+#define HISTORY_JOURNAL_HEADER_SIZE 8
+#define HISTORY_JOURNAL_BUFFER_SIZE 65536
+
+/** unless forced, the journal is only synced once this many entries are waiting, or once this
+    many seconds have passed since it last was (see syncHistoryJournal) */
+#define HISTORY_JOURNAL_SYNC_ENTRIES 1024
+#define HISTORY_JOURNAL_SYNC_SECONDS 1
+
+#define HISTORY_JOURNAL_BOARD 'N'
+#define HISTORY_JOURNAL_STEP 'S'
+#define HISTORY_JOURNAL_POSITION 'P'
+#define HISTORY_JOURNAL_TRUNCATE 'T'
+#define HISTORY_JOURNAL_BRANCH 'R'
+#define HISTORY_JOURNAL_BEGIN_GROUP 'B'
+#define HISTORY_JOURNAL_COMMIT_GROUP 'C'
+
+/** number of steps between full copies of the board kept in a History, unless changed */
+#define HISTORY_CHECKPOINT_INTERVAL_DEFAULT 64
+
 struct HistoryStruct;
 
 typedef struct HistoryStruct *History;
@@ -28,13 +64,36 @@ History createHistory(struct SudokuBoard *owner);
 
 void freeHistory(History *historyPtr);
 
+void clearHistory(History history);
+
 void addUndoStep(History history, struct Coord2D *square, int value);
 
+void beginHistoryGroup(History history);
+
+void commitHistoryGroup(History history);
+
 
 bool undoStep(History history, size_t stepsToUndo);
 
 bool redoStep(History history, size_t stepsToRedo);
 
+bool gotoHistoryStep(History history, size_t step);
+
+void setHistoryCheckpointInterval(History history, size_t interval);
+
+void getHistoryPosition(History history, size_t *currentStep, size_t *length, size_t *checkpointCount,
+     size_t *checkpointInterval);
+
 void invalidateSubsequentRedoSteps(History history);
 
+size_t listHistoryBranches(History history);
+
+bool switchHistoryBranch(History history, size_t branch);
+
+bool openHistoryJournal(History history, const char *fileName, bool *restored);
+
+void syncHistoryJournal(History history, bool isForced);
+
+void closeHistoryJournal(History history);
+
 #endif // !SUDOKU_UNDO_H
@@ -1,6 +1,7 @@
 #ifndef SUDOKU_UTILITY_H
 #define SUDOKU_UTILITY_H
 
+#include <stdio.h>
 #include <stdlib.h>
 
 #define SUDOKU_ROW_COUNT 9
@@ -9,6 +10,8 @@
 #define SUDOKU_BLOCK_WIDTH 3
 #define SUDOKU_BLOCK_HEIGHT 3
 #define SUDOKU_DIGIT_MAX 9
+/** number of other squares sharing a row, column or block with any one square */
+#define SUDOKU_PEER_COUNT 20
 
 /** turn ASCII code into integer, subtracting 1 to convert the human-readable column number to an array index */
 #define SUDOKU_COL_LETTER_TO_INDEX(letter) toupper(letter) - 'A'
@@ -28,6 +31,14 @@
 
 extern const char colLabels[];
 
+extern const unsigned char sudokuSquareRow[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT];
+
+extern const unsigned char sudokuSquareColumn[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT];
+
+extern const unsigned char sudokuSquareBlock[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT];
+
+extern const unsigned char sudokuSquarePeers[SUDOKU_ROW_COUNT * SUDOKU_COL_COUNT][SUDOKU_PEER_COUNT];
+
 
 void ensureCleanInput();
 
@@ -100,6 +111,8 @@ char addCharToString(String *string, char ch);
 
 int readString(String *string);
 
+int readStringLine(String *string, FILE *stream);
+
 void clearString(String *string);
 
 void terminate(const char *message);
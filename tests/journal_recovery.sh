@@ -0,0 +1,41 @@
+#!/bin/sh
+#
+# Checks that a journal cut off in the middle of a group (as a crash during 'solve' would leave
+# it) doesn't pull the steps of the next session into that group.
+#
+# usage: tests/journal_recovery.sh path/to/sudoku
+
+SUDOKU=${1:-./sudoku}
+JOURNAL=$(mktemp)
+OUTPUT=$(mktemp)
+STATUS=0
+
+trap 'rm -f "$JOURNAL" "$OUTPUT"' EXIT
+
+rm -f "$JOURNAL"
+printf 'new easy\nsolve crosshatch\nexit\n' | "$SUDOKU" --script - --journal "$JOURNAL" > /dev/null
+
+# drop the group's commit entry, the last byte of the journal
+SIZE=$(wc -c < "$JOURNAL")
+head -c $((SIZE - 1)) "$JOURNAL" > "$OUTPUT" && cat "$OUTPUT" > "$JOURNAL"
+
+printf 'change A 1 6\nchange B 1 1\nundo\nexit\n' | "$SUDOKU" --script - --journal "$JOURNAL" > "$OUTPUT"
+
+if ! grep -q 'changed B1 from 1 back to 0' "$OUTPUT"
+then
+     echo "FAIL: undo after recovering an open group didn't undo just the last change"
+     STATUS=1
+fi
+
+# the recovered journal must have the group closed for good
+printf 'undo\nundo\nexit\n' | "$SUDOKU" --script - --journal "$JOURNAL" > "$OUTPUT"
+
+if ! grep -q 'changed A1 from 6 back to 0' "$OUTPUT" || ! grep -q 'back as a group' "$OUTPUT"
+then
+     echo "FAIL: the recovered journal didn't keep the group and the later steps apart"
+     STATUS=1
+fi
+
+[ $STATUS -eq 0 ] && echo "PASS: journal recovery"
+
+exit $STATUS